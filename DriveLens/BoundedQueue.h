@@ -0,0 +1,85 @@
+// BoundedQueue.h : Fixed-capacity blocking queue for handing work between
+//                  pipeline threads.
+//
+// Storage is a preallocated circular array, so pushing and popping never
+// allocate. Producers use tryPush() and decide themselves what to do when
+// the queue is full; consumers block in pop() until an item arrives or the
+// queue is closed and drained.
+
+#pragma once
+
+#include "DriveLens.h"
+
+template <typename T>
+class BoundedQueue {
+public:
+	explicit BoundedQueue(size_t capacity)
+		: m_items(capacity > 0 ? capacity : 1) {}
+
+	BoundedQueue(const BoundedQueue&)            = delete;
+	BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+	// Returns false (leaving `item` untouched) if the queue is full or closed.
+	bool tryPush(T&& item)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_closed || m_count == m_items.size()) return false;
+			m_items[(m_head + m_count) % m_items.size()] = std::move(item);
+			++m_count;
+		}
+		m_notEmpty.notify_one();
+		return true;
+	}
+
+	// Non-blocking pop; returns false if the queue is empty.
+	bool tryPop(T& out)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return popLocked(out);
+	}
+
+	// Blocks until an item is available. Returns false once the queue has
+	// been closed and every remaining item consumed.
+	bool pop(T& out)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_notEmpty.wait(lock, [this] { return m_count > 0 || m_closed; });
+		return popLocked(out);
+	}
+
+	// Reject further pushes and wake every blocked consumer.
+	void close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_closed = true;
+		}
+		m_notEmpty.notify_all();
+	}
+
+	size_t size() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_count;
+	}
+
+	size_t capacity() const { return m_items.size(); }
+
+private:
+	bool popLocked(T& out)
+	{
+		if (m_count == 0) return false;
+		out    = std::move(m_items[m_head]);
+		m_head = (m_head + 1) % m_items.size();
+		--m_count;
+		return true;
+	}
+
+	std::vector<T>          m_items;
+	size_t                  m_head   = 0;
+	size_t                  m_count  = 0;
+	bool                    m_closed = false;
+	mutable std::mutex      m_mutex;
+	std::condition_variable m_notEmpty;
+};
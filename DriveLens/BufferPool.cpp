@@ -0,0 +1,49 @@
+// BufferPool.cpp : Leasing of preallocated encode buffers.
+
+#include "BufferPool.h"
+
+BufferPool::BufferPool(size_t count, size_t reserveBytes)
+{
+	m_buffers.reserve(count);
+	m_free.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		auto buffer = std::make_unique<EncodeBuffer>();
+		buffer->jpeg.reserve(reserveBytes);
+		m_free.push_back(buffer.get());
+		m_buffers.push_back(std::move(buffer));
+	}
+}
+
+BufferPool::Lease BufferPool::tryAcquire()
+{
+	EncodeBuffer* buffer = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_free.empty()) {
+			buffer = m_free.back();
+			m_free.pop_back();
+		}
+	}
+
+	if (!buffer) {
+		m_exhausted.fetch_add(1, std::memory_order_relaxed);
+		return {};
+	}
+
+	size_t used = m_inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+	size_t high = m_highWater.load(std::memory_order_relaxed);
+	while (used > high &&
+		   !m_highWater.compare_exchange_weak(high, used, std::memory_order_relaxed)) {}
+
+	return Lease(this, buffer);
+}
+
+void BufferPool::release(EncodeBuffer* buffer)
+{
+	// Keep the JPEG capacity, drop the bytes
+	buffer->jpeg.clear();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_free.push_back(buffer);
+	m_inUse.fetch_sub(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,93 @@
+// BufferPool.h : Fixed set of reusable encode buffers for the upload path.
+//
+// The pipeline thread leases a buffer, resizes and encodes into it, and the
+// upload task returns it when the request finishes (the Lease destructor).
+// Buffers keep their capacity between captures, so once the pool is warm a
+// capture does not touch the heap for its resize target or JPEG bytes.
+// Tiled uploads keep their extra images in `tiles` the same way.
+
+#pragma once
+
+#include "DriveLens.h"
+#include "JpegEncoder.h"
+
+struct EncodeTile {
+	cv::Rect           region;    // part of the frame this tile covers
+	cv::Mat            image;
+	JpegBytes          jpeg;
+};
+
+struct EncodeBuffer {
+	cv::Mat                 resized;   // resize target, reused while the upload size holds
+	JpegBytes               jpeg;      // encoded bytes, capacity kept across uses
+	std::vector<EncodeTile> tiles;     // extra images of a tiled upload, else empty
+};
+
+class BufferPool {
+public:
+	// ── Lease ────────────────────────────────────────────────────────
+	// Move-only handle to one pooled buffer; returns it on destruction.
+	class Lease {
+	public:
+		Lease() = default;
+		Lease(Lease&& other) noexcept
+			: m_pool(std::exchange(other.m_pool, nullptr)),
+			  m_buffer(std::exchange(other.m_buffer, nullptr)) {}
+		Lease& operator=(Lease&& other) noexcept
+		{
+			if (this != &other) {
+				reset();
+				m_pool   = std::exchange(other.m_pool, nullptr);
+				m_buffer = std::exchange(other.m_buffer, nullptr);
+			}
+			return *this;
+		}
+		Lease(const Lease&)            = delete;
+		Lease& operator=(const Lease&) = delete;
+		~Lease() { reset(); }
+
+		explicit operator bool() const { return m_buffer != nullptr; }
+		EncodeBuffer* operator->() const { return m_buffer; }
+		EncodeBuffer& operator*()  const { return *m_buffer; }
+
+		void reset()
+		{
+			if (m_pool) m_pool->release(m_buffer);
+			m_pool   = nullptr;
+			m_buffer = nullptr;
+		}
+
+	private:
+		friend class BufferPool;
+		Lease(BufferPool* pool, EncodeBuffer* buffer)
+			: m_pool(pool), m_buffer(buffer) {}
+
+		BufferPool*   m_pool   = nullptr;
+		EncodeBuffer* m_buffer = nullptr;
+	};
+
+	BufferPool(size_t count, size_t reserveBytes);
+
+	BufferPool(const BufferPool&)            = delete;
+	BufferPool& operator=(const BufferPool&) = delete;
+
+	// Lease a free buffer, or an empty Lease when all are in use.
+	Lease tryAcquire();
+
+	// ── Statistics (any thread) ──────────────────────────────────────
+	size_t   capacity()  const { return m_buffers.size(); }
+	size_t   inUse()     const { return m_inUse.load(std::memory_order_relaxed); }
+	size_t   highWater() const { return m_highWater.load(std::memory_order_relaxed); }
+	uint64_t exhausted() const { return m_exhausted.load(std::memory_order_relaxed); }
+
+private:
+	void release(EncodeBuffer* buffer);
+
+	std::vector<std::unique_ptr<EncodeBuffer>> m_buffers;
+	std::vector<EncodeBuffer*>                 m_free;   // reserved to capacity
+	std::mutex                                 m_mutex;
+
+	std::atomic<size_t>   m_inUse{ 0 };
+	std::atomic<size_t>   m_highWater{ 0 };
+	std::atomic<uint64_t> m_exhausted{ 0 };
+};
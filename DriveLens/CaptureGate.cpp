@@ -0,0 +1,69 @@
+// CaptureGate.cpp : Scene-change gated sampling.
+
+#include "CaptureGate.h"
+#include "config.h"
+
+static uint64_t msToFrames(double fps, int ms)
+{
+	return std::max<uint64_t>(1, static_cast<uint64_t>(fps * ms / 1000.0));
+}
+
+CaptureGate::CaptureGate(double fps)
+	: m_minFrames    (msToFrames(fps, CAPTURE_MIN_MS)),
+	  m_nominalFrames(msToFrames(fps, CAPTURE_INTERVAL_SEC * 1000)),
+	  m_maxFrames    (msToFrames(fps, CAPTURE_MAX_MS)),
+	  m_probeFrames  (msToFrames(fps, CHANGE_PROBE_MS)),
+	  m_frameMs      (1000.0 / fps)
+{
+	// First upload after the nominal interval, as with fixed sampling
+	m_nextProbe = CAPTURE_CHANGE_GATED ? m_minFrames : m_nominalFrames;
+}
+
+// ── requiredGap ──────────────────────────────────────────────────────
+// Frames that must pass since the last upload for a given change score:
+// below CHANGE_LOW only the heartbeat applies, between CHANGE_LOW and
+// CHANGE_HIGH the gap shrinks linearly from nominal to minimum.
+uint64_t CaptureGate::requiredGap(double score) const
+{
+	if (!CAPTURE_CHANGE_GATED) return m_nominalFrames;
+	if (score <  CHANGE_LOW)   return m_maxFrames;
+	if (score >= CHANGE_HIGH)  return m_minFrames;
+
+	double t = (score - CHANGE_LOW) / (CHANGE_HIGH - CHANGE_LOW);
+	return m_nominalFrames -
+		   static_cast<uint64_t>(t * (m_nominalFrames - m_minFrames));
+}
+
+bool CaptureGate::evaluate(const cv::Mat& frame, uint64_t frameIndex)
+{
+	uint64_t elapsed = frameIndex - m_lastSample;
+
+	if (CAPTURE_CHANGE_GATED) {
+		cv::resize(frame, m_scaled, cv::Size(CHANGE_THUMB_WIDTH, CHANGE_THUMB_HEIGHT),
+				   0, 0, cv::INTER_AREA);
+		cv::cvtColor(m_scaled, m_candidate, cv::COLOR_BGR2GRAY);
+
+		m_lastScore.store(m_reference.empty()
+			? CHANGE_HIGH
+			: cv::norm(m_candidate, m_reference, cv::NORM_L1) / m_candidate.total(),
+			std::memory_order_relaxed);
+	}
+
+	uint64_t gap    = requiredGap(lastScore());
+	bool     sample = elapsed >= gap;
+
+	// Re-probe after the probe stride, or exactly when the gap runs out.
+	// accept() overrides this if the sample is actually uploaded.
+	m_nextProbe = frameIndex + (sample ? m_probeFrames
+									   : std::min(m_probeFrames, gap - elapsed));
+	if (!sample) m_gated.fetch_add(1, std::memory_order_relaxed);
+	return sample;
+}
+
+void CaptureGate::accept(uint64_t frameIndex)
+{
+	m_lastGap.store(frameIndex - m_lastSample, std::memory_order_relaxed);
+	m_lastSample = frameIndex;
+	m_nextProbe  = frameIndex + (CAPTURE_CHANGE_GATED ? m_minFrames : m_nominalFrames);
+	std::swap(m_reference, m_candidate);
+}
@@ -0,0 +1,59 @@
+// CaptureGate.h : Decides which frames are sent to the cloud, based on how
+//                 much the scene has changed since the last upload.
+//
+// Each probe downscales the frame to a tiny grayscale thumbnail and takes
+// the mean absolute difference against the thumbnail of the last uploaded
+// frame (cv::resize / cv::cvtColor / cv::norm – all SIMD kernels in
+// OpenCV). The required gap since the last upload shrinks from the nominal
+// CAPTURE_INTERVAL_SEC towards CAPTURE_MIN_MS as the change score rises;
+// a static scene is still sampled every CAPTURE_MAX_MS as a heartbeat.
+//
+// All timing is in frame counts derived from the source FPS, so the gate
+// behaves the same for live cameras, paced playback and --batch runs.
+
+#pragma once
+
+#include "DriveLens.h"
+
+class CaptureGate {
+public:
+	explicit CaptureGate(double fps);
+
+	// Cheap check, no pixels touched: true when `frameIndex` should be
+	// evaluated. Callers that can skip decoding (--batch) use this first.
+	bool probeDue(uint64_t frameIndex) const { return frameIndex >= m_nextProbe; }
+
+	// Score `frame` against the last accepted sample and decide whether it
+	// should be uploaded. Does not change the reference; call accept() once
+	// the frame has actually been handed to the upload stage.
+	bool evaluate(const cv::Mat& frame, uint64_t frameIndex);
+
+	// The frame last passed to evaluate() was uploaded: make it the new
+	// reference for change detection.
+	void accept(uint64_t frameIndex);
+
+	// Statistics, readable from any thread. gated() counts probes that did
+	// not upload; lastIntervalMs() is the gap between the last two uploads.
+	double   lastScore()      const { return m_lastScore.load(std::memory_order_relaxed); }
+	uint64_t gated()          const { return m_gated.load(std::memory_order_relaxed); }
+	double   lastIntervalMs() const { return m_lastGap.load(std::memory_order_relaxed) * m_frameMs; }
+
+private:
+	uint64_t requiredGap(double score) const;
+
+	uint64_t m_minFrames;
+	uint64_t m_nominalFrames;
+	uint64_t m_maxFrames;
+	uint64_t m_probeFrames;
+	double   m_frameMs;
+
+	cv::Mat  m_scaled;          // scratch: colour thumbnail
+	cv::Mat  m_candidate;       // grayscale thumbnail of the probed frame
+	cv::Mat  m_reference;       // grayscale thumbnail of the last upload
+	uint64_t m_lastSample = 0;
+	uint64_t m_nextProbe  = 0;
+
+	std::atomic<double>   m_lastScore{ 0.0 };
+	std::atomic<uint64_t> m_gated{ 0 };
+	std::atomic<uint64_t> m_lastGap{ 0 };   // frames between the last two uploads
+};
@@ -0,0 +1,322 @@
+// CloudResponse.cpp : DOM and SAX parsers for the detection response.
+
+#include "CloudResponse.h"
+#include "config.h"
+#include "CocoClasses.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+// ── DetectionSax ─────────────────────────────────────────────────────
+// Event handler for json::sax_parse. Only values at the depths we care
+// about are used: the fields of an image object (the response itself, or
+// each element of a "tiles" list) and the fields of each element of its
+// "detected_objects". m_base is the depth offset of the image object
+// being filled: 0 for the response, 2 inside "tiles". Anything else,
+// including unknown nested containers, is skipped by depth.
+class DetectionSax {
+public:
+	// Elements of a "tiles" list go to `tiles`; without it the list is
+	// skipped like any unknown field.
+	explicit DetectionSax(CloudResult& result, std::vector<CloudResult>* tiles = nullptr)
+		: m_result(result), m_tiles(tiles), m_image(&result) {}
+
+	bool sawTiles() const { return m_sawTiles; }
+
+	bool null()                         { return true; }
+	bool boolean(bool)                  { return true; }
+	bool number_integer(int64_t v)      { return number(static_cast<double>(v), v); }
+	bool number_unsigned(uint64_t v)    { return number(static_cast<double>(v), static_cast<int64_t>(v)); }
+	bool number_float(double v, const std::string&) { return number(v, static_cast<int64_t>(v)); }
+	bool binary(json::binary_t&)        { return true; }
+
+	// Older servers send only the name; class_id wins when both are present
+	bool string(std::string& v)
+	{
+		if (inDetection() && m_field == Field::Name) {
+			Detection& det = m_image->objects.back();
+			if (det.classId == COCO_UNKNOWN) det.classId = cocoClassId(v);
+		}
+		return true;
+	}
+
+	bool start_object(size_t)
+	{
+		++m_depth;
+		if (m_inTiles && m_base == 0 && m_depth == 3) {
+			m_image = &m_tiles->emplace_back();
+			m_image->objects.reserve(PARSE_RESERVE);
+			m_base  = 2;
+		} else if (inDetection()) {
+			Detection& det = m_image->objects.emplace_back();
+			det.classId    = COCO_UNKNOWN;
+			det.confidence = 0.0f;
+			det.x_min = det.y_min = det.x_max = det.y_max = 0;
+		}
+		return true;
+	}
+
+	bool end_object()
+	{
+		if (m_base == 2 && m_depth == 3) {
+			m_image = &m_result;
+			m_base  = 0;
+		}
+		--m_depth;
+		return true;
+	}
+
+	bool start_array(size_t)
+	{
+		++m_depth;
+		if (m_depth == m_base + 2 && m_top == Top::Objects) {
+			m_inObjects = true;
+		} else if (m_depth == 2 && m_top == Top::Tiles) {
+			m_inTiles  = true;
+			m_sawTiles = true;
+		}
+		return true;
+	}
+
+	bool end_array()
+	{
+		if (m_depth == m_base + 2) m_inObjects = false;
+		if (m_depth == 2)          m_inTiles   = false;
+		--m_depth;
+		return true;
+	}
+
+	bool key(std::string& k)
+	{
+		if (m_depth == m_base + 1) {
+			m_top = k == "image_width"      ? Top::Width
+				  : k == "image_height"     ? Top::Height
+				  : k == "frame_index"      ? Top::FrameIndex
+				  : k == "capture_ns"       ? Top::CaptureNs
+				  : k == "detected_objects" ? Top::Objects
+				  : k == "tiles" && m_tiles && m_base == 0 ? Top::Tiles
+				  :                           Top::Other;
+		} else if (inDetection()) {
+			m_field = k == "name"       ? Field::Name
+					: k == "class_id"   ? Field::ClassId
+					: k == "confidence" ? Field::Confidence
+					: k == "x_min"      ? Field::XMin
+					: k == "y_min"      ? Field::YMin
+					: k == "x_max"      ? Field::XMax
+					: k == "y_max"      ? Field::YMax
+					:                     Field::Other;
+		}
+		return true;
+	}
+
+	bool parse_error(size_t position, const std::string&, const json::exception& e)
+	{
+		std::cerr << "[JSON] Parse error at byte " << position << ": " << e.what() << std::endl;
+		m_result.objects.clear();
+		if (m_tiles) m_tiles->clear();
+		return false;
+	}
+
+private:
+	enum class Top   { Other, Width, Height, FrameIndex, CaptureNs, Objects, Tiles };
+	enum class Field { Other, Name, ClassId, Confidence, XMin, YMin, XMax, YMax };
+
+	bool inDetection() const { return m_inObjects && m_depth == m_base + 3; }
+
+	bool number(double v, int64_t i)
+	{
+		if (m_depth == m_base + 1) {
+			switch (m_top) {
+			case Top::Width:      m_image->imageWidth  = static_cast<int>(i); break;
+			case Top::Height:     m_image->imageHeight = static_cast<int>(i); break;
+			case Top::FrameIndex: m_image->frameIndex  = i; break;
+			case Top::CaptureNs:  m_image->captureNs   = i; break;
+			default: break;
+			}
+		} else if (inDetection()) {
+			Detection& det = m_image->objects.back();
+			switch (m_field) {
+			case Field::ClassId:    det.classId = cocoClassName(static_cast<int>(i))
+												  ? static_cast<uint8_t>(i) : COCO_UNKNOWN; break;
+			case Field::Confidence: det.confidence = static_cast<float>(v); break;
+			case Field::XMin:       det.x_min = static_cast<int>(i); break;
+			case Field::YMin:       det.y_min = static_cast<int>(i); break;
+			case Field::XMax:       det.x_max = static_cast<int>(i); break;
+			case Field::YMax:       det.y_max = static_cast<int>(i); break;
+			default: break;
+			}
+		}
+		return true;
+	}
+
+	CloudResult&              m_result;
+	std::vector<CloudResult>* m_tiles;
+	CloudResult*              m_image;       // object being filled
+	int                       m_depth     = 0;
+	int                       m_base      = 0;
+	bool                      m_inObjects = false;
+	bool                      m_inTiles   = false;
+	bool                      m_sawTiles  = false;
+	Top                       m_top       = Top::Other;
+	Field                     m_field     = Field::Other;
+};
+
+} // namespace
+
+// Little-endian field readers; independent of host byte order
+static uint16_t readU16(const uchar* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+static int16_t  readI16(const uchar* p) { return static_cast<int16_t>(readU16(p)); }
+static int64_t  readI64(const uchar* p)
+{
+	uint64_t v = 0;
+	for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+	return static_cast<int64_t>(v);
+}
+
+// ── parseCloudResponse ───────────────────────────────────────────────
+CloudResult parseCloudResponse(const std::string& body)
+{
+	CloudResult result;
+	if (body.empty()) return result;
+
+	if (body.compare(0, 4, "DLD1") == 0)
+		return parseCloudResponseBinary(body);
+
+	result.objects.reserve(PARSE_RESERVE);
+	DetectionSax sax(result);
+	json::sax_parse(body, &sax);
+	return result;
+}
+
+// ── parseCloudResponseBinary ─────────────────────────────────────────
+CloudResult parseCloudResponseBinary(std::string_view body)
+{
+	CloudResult result;
+	const uchar* p = reinterpret_cast<const uchar*>(body.data());
+
+	if (body.size() < BINARY_HEADER_SIZE || body.compare(0, 4, "DLD1") != 0) {
+		std::cerr << "[Binary] Bad response header (" << body.size() << " bytes)" << std::endl;
+		return result;
+	}
+
+	size_t count = readU16(p + 24);
+	if (body.size() != BINARY_HEADER_SIZE + count * BINARY_RECORD_SIZE) {
+		std::cerr << "[Binary] Truncated response: " << body.size() << " bytes for "
+				  << count << " records" << std::endl;
+		return result;
+	}
+
+	result.imageWidth  = readU16(p + 4);
+	result.imageHeight = readU16(p + 6);
+	result.frameIndex  = readI64(p + 8);
+	result.captureNs   = readI64(p + 16);
+
+	result.objects.resize(count);
+	const uchar* rec = p + BINARY_HEADER_SIZE;
+	for (size_t i = 0; i < count; ++i, rec += BINARY_RECORD_SIZE) {
+		Detection& det = result.objects[i];
+		det.classId    = cocoClassName(rec[0]) ? rec[0] : COCO_UNKNOWN;
+		det.confidence = readU16(rec + 1) / 65535.0f;
+		det.x_min      = readI16(rec + 3);
+		det.y_min      = readI16(rec + 5);
+		det.x_max      = readI16(rec + 7);
+		det.y_max      = readI16(rec + 9);
+	}
+	return result;
+}
+
+// ── fromJson ─────────────────────────────────────────────────────────
+// One image's result from a DOM object.
+static CloudResult fromJson(const json& j)
+{
+	CloudResult result;
+	result.imageWidth  = j.value("image_width",  RESIZE_WIDTH);
+	result.imageHeight = j.value("image_height", RESIZE_HEIGHT);
+
+	// Echoed capture metadata; null when the upload did not carry it
+	auto echoed = [&j](const char* key, int64_t fallback) {
+		auto it = j.find(key);
+		return (it != j.end() && it->is_number_integer()) ? it->get<int64_t>() : fallback;
+	};
+	result.frameIndex = echoed("frame_index", -1);
+	result.captureNs  = echoed("capture_ns",  0);
+
+	if (j.contains("detected_objects") && j["detected_objects"].is_array()) {
+		for (auto& obj : j["detected_objects"]) {
+			Detection det;
+			int classId    = obj.value("class_id", -1);
+			det.classId    = cocoClassName(classId) ? static_cast<uint8_t>(classId)
+													: cocoClassId(obj.value("name", ""));
+			det.confidence = obj.value("confidence", 0.0f);
+			det.x_min      = obj.value("x_min", 0);
+			det.y_min      = obj.value("y_min", 0);
+			det.x_max      = obj.value("x_max", 0);
+			det.y_max      = obj.value("y_max", 0);
+			result.objects.push_back(det);
+		}
+	}
+	return result;
+}
+
+// ── parseCloudResponseDom ────────────────────────────────────────────
+CloudResult parseCloudResponseDom(const std::string& jsonStr)
+{
+	if (jsonStr.empty()) return {};
+
+	try {
+		auto j = json::parse(jsonStr);
+		return fromJson(j);
+	} catch (const json::exception& e) {
+		std::cerr << "[JSON] Parse error: " << e.what() << std::endl;
+	}
+	return {};
+}
+
+// ── parseCloudResponseTiles ──────────────────────────────────────────
+std::vector<CloudResult> parseCloudResponseTiles(const std::string& body)
+{
+	std::vector<CloudResult> tiles;
+	if (body.empty()) return tiles;
+
+	// Binary: one self-sized record block per tile, back to back
+	if (body.compare(0, 4, "DLD1") == 0) {
+		std::string_view rest = body;
+		while (!rest.empty()) {
+			if (rest.size() < BINARY_HEADER_SIZE) {
+				std::cerr << "[Binary] Truncated tile header " << tiles.size() << " ("
+						  << rest.size() << " bytes left)" << std::endl;
+				tiles.clear();
+				break;
+			}
+			size_t len = BINARY_HEADER_SIZE
+					   + readU16(reinterpret_cast<const uchar*>(rest.data()) + 24) * BINARY_RECORD_SIZE;
+			if (len > rest.size()) {
+				std::cerr << "[Binary] Truncated tile " << tiles.size() << " ("
+						  << rest.size() << " bytes left)" << std::endl;
+				tiles.clear();
+				break;
+			}
+			tiles.push_back(parseCloudResponseBinary(rest.substr(0, len)));
+			rest.remove_prefix(len);
+		}
+		return tiles;
+	}
+
+	// JSON: a "tiles" list, or a single-image response. The echoed
+	// capture metadata sits next to the list and applies to every tile.
+	CloudResult top;
+	top.objects.reserve(PARSE_RESERVE);
+	DetectionSax sax(top, &tiles);
+	if (!json::sax_parse(body, &sax)) {
+		tiles.clear();
+	} else if (!sax.sawTiles()) {
+		tiles.push_back(std::move(top));
+	} else {
+		for (CloudResult& tile : tiles) {
+			tile.frameIndex = top.frameIndex;
+			tile.captureNs  = top.captureNs;
+		}
+	}
+	return tiles;
+}
@@ -0,0 +1,36 @@
+// CloudResponse.h : Parsing of the server's /upload response.
+//
+// The server answers either in JSON or, when the upload's Accept header
+// asks for BINARY_CONTENT_TYPE, in a compact little-endian format:
+//
+//   header (26 bytes)   char[4] "DLD1", u16 image_width, u16 image_height,
+//                       i64 frame_index (-1 = none), i64 capture_ns, u16 count
+//   record (11 bytes)   u8 class_id (COCO), u16 confidence (x 65535),
+//                       i16 x_min, y_min, x_max, y_max
+//
+// Class names are looked up in CocoClasses.h rather than sent per object.
+// A tiled upload is answered with one such block per tile, back to back,
+// or in JSON with a "tiles" list of per-image objects.
+//
+// JSON is parsed in a single streaming pass using nlohmann's SAX interface:
+// values are written straight into the CloudResult without building a DOM.
+// parseCloudResponseDom() is the original DOM-based parser, kept as the
+// reference for bench/ParseBench.
+
+#pragma once
+
+#include "DriveLens.h"
+#include "Detection.h"
+
+constexpr const char* BINARY_CONTENT_TYPE = "application/x-drivelens-detections";
+constexpr size_t      BINARY_HEADER_SIZE  = 26;
+constexpr size_t      BINARY_RECORD_SIZE  = 11;
+
+// Parse either format, told apart by the binary magic.
+CloudResult parseCloudResponse(const std::string& body);
+
+// Per-tile results of a multi-file upload, in upload order.
+std::vector<CloudResult> parseCloudResponseTiles(const std::string& body);
+
+CloudResult parseCloudResponseBinary(std::string_view body);
+CloudResult parseCloudResponseDom(const std::string& jsonStr);
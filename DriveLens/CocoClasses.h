@@ -0,0 +1,45 @@
+// CocoClasses.h : Class-id table shared with the server.
+//
+// Must match _COCO_NAMES in server/ocr.py: detections carry only the COCO
+// class id, and labels are interned here rather than stored per object.
+// The local detector reports the same subset of classes.
+
+#pragma once
+
+#include "DriveLens.h"
+
+// Class id of a detection whose label the table does not know.
+constexpr uint8_t COCO_UNKNOWN = 255;
+
+// Name of a driving-relevant COCO class, or nullptr for any other id.
+inline const char* cocoClassName(int classId)
+{
+	switch (classId) {
+	case 0:  return "person";
+	case 1:  return "bicycle";
+	case 2:  return "car";
+	case 3:  return "motorcycle";
+	case 5:  return "bus";
+	case 7:  return "truck";
+	case 9:  return "traffic light";
+	case 11: return "stop sign";
+	default: return nullptr;
+	}
+}
+
+// Display label for any class id; never null.
+inline const char* cocoLabel(int classId)
+{
+	const char* name = cocoClassName(classId);
+	return name ? name : "unknown";
+}
+
+// Reverse lookup for responses that only carry the name.
+inline uint8_t cocoClassId(std::string_view name)
+{
+	for (int id = 0; id < 12; ++id) {
+		const char* known = cocoClassName(id);
+		if (known && name == known) return static_cast<uint8_t>(id);
+	}
+	return COCO_UNKNOWN;
+}
@@ -0,0 +1,108 @@
+// DebugArchive.cpp : Segment files of the debug frame archive.
+
+#include "DebugArchive.h"
+
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+fs::path archivePath(const fs::path& dir, uint64_t seq, const char* extension)
+{
+	std::string name = std::to_string(seq);
+	if (name.size() < 8) name.insert(0, 8 - name.size(), '0');
+	return dir / ("archive_" + name + extension);
+}
+
+std::vector<uint64_t> archiveSegments(const fs::path& dir)
+{
+	std::vector<uint64_t> segments;
+	std::error_code ec;
+	for (const auto& entry : fs::directory_iterator(dir, ec)) {
+		std::string name = entry.path().filename().string();
+		if (entry.path().extension() != ".dli" || name.rfind("archive_", 0) != 0) continue;
+		std::string digits = entry.path().stem().string().substr(8);
+		if (digits.empty() || digits.find_first_not_of("0123456789") != std::string::npos)
+			continue;
+		segments.push_back(std::stoull(digits));
+	}
+	std::sort(segments.begin(), segments.end());
+	return segments;
+}
+
+static ArchiveFileHeader fileHeader(const char (&magic)[4])
+{
+	ArchiveFileHeader header{};
+	std::memcpy(header.magic, magic, sizeof(header.magic));
+	header.version = ARCHIVE_VERSION;
+	return header;
+}
+
+DebugArchive::DebugArchive(fs::path dir, uint64_t segmentBytes)
+	: m_dir(std::move(dir)), m_segmentBytes(segmentBytes)
+{
+	// Continue numbering after the newest segment of earlier runs
+	std::vector<uint64_t> existing = archiveSegments(m_dir);
+	m_seq = existing.empty() ? 0 : existing.back() + 1;
+}
+
+bool DebugArchive::openSegment()
+{
+	m_data.close();
+	m_index.close();
+	m_data.clear();
+	m_index.clear();
+
+	fs::path dataPath = archivePath(m_dir, m_seq, ".dla");
+	m_data.open(dataPath, std::ios::binary | std::ios::trunc);
+	m_index.open(archivePath(m_dir, m_seq, ".dli"), std::ios::binary | std::ios::trunc);
+	++m_seq;
+	if (!m_data.is_open() || !m_index.is_open()) {
+		std::cerr << "[Debug] Cannot open archive " << dataPath.string() << std::endl;
+		m_data.close();
+		m_index.close();
+		return false;
+	}
+
+	ArchiveFileHeader data  = fileHeader(ARCHIVE_DATA_MAGIC);
+	ArchiveFileHeader index = fileHeader(ARCHIVE_INDEX_MAGIC);
+	m_data.write(reinterpret_cast<const char*>(&data), sizeof(data));
+	m_index.write(reinterpret_cast<const char*>(&index), sizeof(index));
+	m_offset = sizeof(data);
+	std::cout << "[Debug] Archiving frames to " << dataPath.string() << std::endl;
+	return true;
+}
+
+// ── append ───────────────────────────────────────────────────────────
+bool DebugArchive::append(uint64_t captureIndex, int64_t wallMs, std::span<const uchar> jpeg)
+{
+	uint64_t record = sizeof(uint32_t) + jpeg.size();
+	bool full = m_offset + record > m_segmentBytes && m_offset > sizeof(ArchiveFileHeader);
+	if ((!m_data.is_open() || full) && !openSegment()) return false;
+
+	uint32_t bytes = static_cast<uint32_t>(jpeg.size());
+	m_data.write(reinterpret_cast<const char*>(&bytes), sizeof(bytes));
+	m_data.write(reinterpret_cast<const char*>(jpeg.data()),
+				 static_cast<std::streamsize>(jpeg.size()));
+	m_data.flush();
+
+	// Index only data that is known to be on disk
+	if (m_data) {
+		ArchiveIndexEntry entry{};
+		entry.offset       = m_offset + sizeof(bytes);
+		entry.bytes        = bytes;
+		entry.captureIndex = captureIndex;
+		entry.wallMs       = wallMs;
+		m_index.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+		m_index.flush();
+	}
+
+	if (!m_data || !m_index) {
+		// Leave the damaged segment as it is; the next frame starts a new one
+		std::cerr << "[Debug] Archive write failed for frame " << captureIndex << std::endl;
+		m_data.close();
+		m_index.close();
+		return false;
+	}
+	m_offset += record;
+	return true;
+}
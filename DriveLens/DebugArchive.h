@@ -0,0 +1,76 @@
+// DebugArchive.h : Append-only container for debug frame dumps.
+//
+// Instead of one file per capture, frames go into a few large segments in
+// DEBUG_OUTPUT_DIR, each a pair of files:
+//
+//   archive_NNNNNNNN.dla  ArchiveFileHeader, then per frame a u32 length
+//                         and the JPEG bytes, back to back
+//   archive_NNNNNNNN.dli  ArchiveFileHeader, then one fixed-size
+//                         ArchiveIndexEntry per frame, in the same order
+//
+// Both files are only ever appended to, so writes stay sequential on the
+// SD card. Entry i of the index sits at a fixed offset, which lets a
+// reader map the two files and fetch frame i in O(1) (tools/ArchiveReader).
+// The index entry is written after the frame's data, so after a crash the
+// index never points past the end of the data file; a torn trailing entry
+// is ignored by rounding the index size down.
+//
+// Every process start opens a new segment, and a segment is closed at
+// about DEBUG_ARCHIVE_BYTES. Headers, lengths and index entries are written
+// as raw structs in host byte order; ArchiveReader maps them back the same
+// way, so it must run on a machine of the same byte order as the vehicle.
+
+#pragma once
+
+#include "DriveLens.h"
+
+#include <fstream>
+
+struct ArchiveFileHeader {
+	char     magic[4];   // "DLA1" (data) or "DLI1" (index)
+	uint32_t version;    // ARCHIVE_VERSION
+	uint64_t reserved;
+};
+static_assert(sizeof(ArchiveFileHeader) == 16, "ArchiveFileHeader must not be padded");
+
+struct ArchiveIndexEntry {
+	uint64_t offset;         // of the JPEG bytes in the .dla file (after the length)
+	uint32_t bytes;
+	uint32_t reserved;
+	uint64_t captureIndex;
+	int64_t  wallMs;         // system_clock time of the capture
+};
+static_assert(sizeof(ArchiveIndexEntry) == 32, "ArchiveIndexEntry must not be padded");
+static_assert(std::is_trivially_copyable_v<ArchiveIndexEntry>);
+
+constexpr uint32_t ARCHIVE_VERSION = 1;
+constexpr char     ARCHIVE_DATA_MAGIC[4]  = { 'D', 'L', 'A', '1' };
+constexpr char     ARCHIVE_INDEX_MAGIC[4] = { 'D', 'L', 'I', '1' };
+
+// Path of segment `seq`'s data (".dla") or index (".dli") file in `dir`.
+std::filesystem::path archivePath(const std::filesystem::path& dir, uint64_t seq,
+								  const char* extension);
+
+// Segment numbers present in `dir`, ascending.
+std::vector<uint64_t> archiveSegments(const std::filesystem::path& dir);
+
+// Writer side. Not thread-safe: owned by the debug writer thread.
+class DebugArchive {
+public:
+	DebugArchive(std::filesystem::path dir, uint64_t segmentBytes);
+
+	DebugArchive(const DebugArchive&)            = delete;
+	DebugArchive& operator=(const DebugArchive&) = delete;
+
+	bool append(uint64_t captureIndex, int64_t wallMs, std::span<const uchar> jpeg);
+
+private:
+	bool openSegment();
+
+	std::filesystem::path m_dir;
+	uint64_t              m_segmentBytes;
+	uint64_t              m_seq    = 0;
+	uint64_t              m_offset = 0;   // current size of the .dla file
+	std::ofstream         m_data;
+	std::ofstream         m_index;
+};
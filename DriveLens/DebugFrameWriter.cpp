@@ -0,0 +1,65 @@
+// DebugFrameWriter.cpp : Background writer for debug frame dumps.
+
+#include "DebugFrameWriter.h"
+
+DebugFrameWriter::DebugFrameWriter(std::string dir, uint64_t segmentBytes, size_t depth,
+								   size_t reserveBytes)
+	: m_dir(std::move(dir)), m_archive(m_dir, segmentBytes),
+	  m_pending(depth), m_free(depth)
+{
+	// Created once here rather than checked on every save
+	std::error_code ec;
+	std::filesystem::create_directories(m_dir, ec);
+	if (ec) {
+		std::cerr << "[Debug] Cannot create " << m_dir.string() << ": "
+				  << ec.message() << std::endl;
+		return;
+	}
+	m_ready = true;
+
+	for (size_t i = 0; i < m_free.capacity(); ++i) {
+		Item item;
+		item.bytes.reserve(reserveBytes);
+		m_free.tryPush(std::move(item));
+	}
+	m_thread = std::jthread([this] { run(); });
+}
+
+DebugFrameWriter::~DebugFrameWriter()
+{
+	// Write what is already queued, then stop
+	m_pending.close();
+	if (m_thread.joinable()) m_thread.join();
+	if (m_dropped.load(std::memory_order_relaxed) > 0)
+		std::cout << "[Debug] " << m_written << " frame(s) saved, "
+				  << m_dropped << " dropped (disk too slow or write failed)" << std::endl;
+}
+
+// ── save ─────────────────────────────────────────────────────────────
+bool DebugFrameWriter::save(uint64_t captureIndex, int64_t wallMs, std::span<const uchar> jpeg)
+{
+	Item item;
+	if (!m_ready || !m_free.tryPop(item)) {
+		m_dropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	item.captureIndex = captureIndex;
+	item.wallMs       = wallMs;
+	item.bytes.assign(jpeg.begin(), jpeg.end());
+
+	// Cannot be full: items are bounded by the free list
+	return m_pending.tryPush(std::move(item));
+}
+
+// ── run ──────────────────────────────────────────────────────────────
+void DebugFrameWriter::run()
+{
+	Item item;
+	while (m_pending.pop(item)) {
+		bool saved = m_archive.append(item.captureIndex, item.wallMs, item.bytes);
+		(saved ? m_written : m_dropped).fetch_add(1, std::memory_order_relaxed);
+
+		item.bytes.clear();
+		m_free.tryPush(std::move(item));
+	}
+}
@@ -0,0 +1,51 @@
+// DebugFrameWriter.h : Saves uploaded JPEGs for debugging on a background
+//                      thread.
+//
+// The bytes are the ones that were uploaded, appended as-is to the debug
+// archive (DebugArchive.h): no second encode, one file per segment instead
+// of per frame, and no file I/O on the pipeline or upload threads.
+// save() copies them into one of DEBUG_QUEUE_DEPTH preallocated buffers and
+// queues it; when the disk falls behind and every buffer is waiting, the
+// frame is dropped and counted instead of blocking the caller.
+
+#pragma once
+
+#include "DriveLens.h"
+#include "BoundedQueue.h"
+#include "DebugArchive.h"
+
+class DebugFrameWriter {
+public:
+	DebugFrameWriter(std::string dir, uint64_t segmentBytes, size_t depth,
+					 size_t reserveBytes);
+	~DebugFrameWriter();
+
+	DebugFrameWriter(const DebugFrameWriter&)            = delete;
+	DebugFrameWriter& operator=(const DebugFrameWriter&) = delete;
+
+	// Queue `jpeg` for the archive. Never blocks; returns false when the
+	// frame was dropped.
+	bool save(uint64_t captureIndex, int64_t wallMs, std::span<const uchar> jpeg);
+
+	uint64_t written() const { return m_written.load(std::memory_order_relaxed); }
+	uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+	struct Item {
+		uint64_t           captureIndex = 0;
+		int64_t            wallMs       = 0;
+		std::vector<uchar> bytes;
+	};
+
+	void run();
+
+	std::filesystem::path    m_dir;
+	bool                     m_ready = false;   // directory exists
+	DebugArchive             m_archive;         // writer thread only
+	BoundedQueue<Item>       m_pending;
+	BoundedQueue<Item>       m_free;            // buffers not in use, capacity kept
+
+	std::atomic<uint64_t>    m_written{ 0 };
+	std::atomic<uint64_t>    m_dropped{ 0 };
+	std::jthread             m_thread;
+};
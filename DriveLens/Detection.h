@@ -0,0 +1,26 @@
+// Detection.h : Detection results shared by the parser, tracker and overlay.
+
+#pragma once
+
+#include "DriveLens.h"
+#include "config.h"
+
+// ── Detection data parsed from the server response ───────────────────
+// Plain data: results are copied every frame (lastDetection, tracker),
+// so the label is a COCO class id into CocoClasses.h, not a string.
+struct Detection {
+	uint8_t classId;      // COCO class id, COCO_UNKNOWN if unmapped
+	float   confidence;
+	int     x_min, y_min, x_max, y_max;
+};
+static_assert(std::is_trivially_copyable_v<Detection>);
+
+// Box coordinates are in pixels of the image the server analyzed
+// (imageWidth x imageHeight), not of the displayed frame.
+struct CloudResult {
+	std::vector<Detection> objects;
+	int                    imageWidth  = RESIZE_WIDTH;
+	int                    imageHeight = RESIZE_HEIGHT;
+	int64_t                frameIndex  = -1;   // echoed capture metadata, checked
+	int64_t                captureNs   = 0;    // against the upload it came back on
+};
@@ -0,0 +1,102 @@
+// DetectionLog.cpp : Writer thread of the on-vehicle detection log.
+
+#include "DetectionLog.h"
+
+#include <cstring>
+
+static int16_t clampCoord(int v)
+{
+	return static_cast<int16_t>(std::clamp(v, INT16_MIN, INT16_MAX));
+}
+
+DetectionLog::DetectionLog(const std::string& path, size_t queueRecords, size_t batchRecords)
+	: m_batch(batchRecords > 0 ? batchRecords : 1), m_queue(queueRecords)
+{
+	if (path.empty()) return;
+
+	// Keep only whole records of an earlier run; start fresh on a foreign file
+	std::error_code ec;
+	uint64_t size = std::filesystem::file_size(path, ec);
+	bool valid = false;
+	if (!ec && size >= sizeof(DetectionLogHeader)) {
+		DetectionLogHeader header{};
+		if (std::FILE* in = std::fopen(path.c_str(), "rb")) {
+			valid = std::fread(&header, sizeof(header), 1, in) == 1
+				 && std::memcmp(header.magic, DETECTION_LOG_MAGIC, sizeof(header.magic)) == 0
+				 && header.version == DETECTION_LOG_VERSION
+				 && header.recordSize == sizeof(DetectionRecord);
+			std::fclose(in);
+		}
+	}
+	if (valid) {
+		uint64_t whole = sizeof(DetectionLogHeader) + (size - sizeof(DetectionLogHeader))
+					   / sizeof(DetectionRecord) * sizeof(DetectionRecord);
+		if (whole < size) std::filesystem::resize_file(path, whole, ec);
+		m_file = std::fopen(path.c_str(), "ab");
+	} else {
+		if (!ec && size > 0)
+			std::cerr << "[DetLog] " << path << " is not a detection log, overwriting" << std::endl;
+		m_file = std::fopen(path.c_str(), "wb");
+		if (m_file) {
+			DetectionLogHeader header{};
+			std::memcpy(header.magic, DETECTION_LOG_MAGIC, sizeof(header.magic));
+			header.version    = DETECTION_LOG_VERSION;
+			header.recordSize = sizeof(DetectionRecord);
+			std::fwrite(&header, sizeof(header), 1, m_file);
+		}
+	}
+
+	if (!m_file) {
+		std::cerr << "[DetLog] Cannot open " << path << std::endl;
+		return;
+	}
+	m_thread = std::jthread([this] { run(); });
+}
+
+DetectionLog::~DetectionLog()
+{
+	// Write what is already queued, then stop
+	m_queue.close();
+	if (m_thread.joinable()) m_thread.join();
+	if (m_file) std::fclose(m_file);
+}
+
+// ── log ──────────────────────────────────────────────────────────────
+void DetectionLog::log(const CloudResult& result, uint64_t frameIndex, int64_t wallMs)
+{
+	if (!m_file) return;
+
+	for (const Detection& det : result.objects) {
+		DetectionRecord record{};
+		record.wallMs     = wallMs;
+		record.frameIndex = frameIndex;
+		record.confidence = det.confidence;
+		record.x_min      = clampCoord(det.x_min);
+		record.y_min      = clampCoord(det.y_min);
+		record.x_max      = clampCoord(det.x_max);
+		record.y_max      = clampCoord(det.y_max);
+		record.classId    = det.classId;
+		if (!m_queue.tryPush(std::move(record)))
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+// ── run ──────────────────────────────────────────────────────────────
+// Block for the first record, then take whatever else is queued (up to a
+// batch) and append it in one write.
+void DetectionLog::run()
+{
+	std::vector<DetectionRecord> batch(m_batch);
+	while (m_queue.pop(batch[0])) {
+		size_t count = 1;
+		while (count < batch.size() && m_queue.tryPop(batch[count])) ++count;
+
+		size_t done = std::fwrite(batch.data(), sizeof(DetectionRecord), count, m_file);
+		std::fflush(m_file);
+		m_written.fetch_add(done, std::memory_order_relaxed);
+		if (done < count) {
+			std::cerr << "[DetLog] Write failed, " << count - done << " record(s) lost" << std::endl;
+			m_dropped.fetch_add(count - done, std::memory_order_relaxed);
+		}
+	}
+}
@@ -0,0 +1,73 @@
+// DetectionLog.h : Append-only binary log of every detection, kept on the
+//                  vehicle.
+//
+// One fixed-size DetectionRecord per detected object, after a short file
+// header. Fixed records make the file trivially memory-mappable: record i
+// sits at sizeof(DetectionLogHeader) + i * sizeof(DetectionRecord), and a
+// record torn by a crash is cut off on the next open by rounding the file
+// size down. tools/DetectionQuery scans it with class / time / confidence
+// filters.
+//
+// log() is called from the upload workers with a result already in frame
+// pixels. It only queues the records; a writer thread drains the queue and
+// appends whatever has accumulated in one write. When the disk cannot keep
+// up and the queue is full, records are dropped and counted.
+
+#pragma once
+
+#include "DriveLens.h"
+#include "BoundedQueue.h"
+#include "Detection.h"
+
+#include <cstdio>
+
+struct DetectionLogHeader {
+	char     magic[4];       // "DLG1"
+	uint32_t version;        // DETECTION_LOG_VERSION
+	uint32_t recordSize;     // sizeof(DetectionRecord)
+	uint32_t reserved;
+};
+static_assert(sizeof(DetectionLogHeader) == 16, "DetectionLogHeader must not be padded");
+
+struct DetectionRecord {
+	int64_t  wallMs;         // system_clock time of the capture
+	uint64_t frameIndex;
+	float    confidence;
+	int16_t  x_min, y_min, x_max, y_max;   // frame pixels
+	uint8_t  classId;        // COCO id, see CocoClasses.h
+	uint8_t  reserved[3];
+};
+static_assert(sizeof(DetectionRecord) == 32, "DetectionRecord must not be padded");
+static_assert(std::is_trivially_copyable_v<DetectionRecord>);
+
+constexpr uint32_t DETECTION_LOG_VERSION = 1;
+constexpr char     DETECTION_LOG_MAGIC[4] = { 'D', 'L', 'G', '1' };
+
+class DetectionLog {
+public:
+	// An empty `path` disables the log.
+	DetectionLog(const std::string& path, size_t queueRecords, size_t batchRecords);
+	~DetectionLog();
+
+	DetectionLog(const DetectionLog&)            = delete;
+	DetectionLog& operator=(const DetectionLog&) = delete;
+
+	bool available() const { return m_file != nullptr; }
+
+	// Queue every object of `result`. Never blocks.
+	void log(const CloudResult& result, uint64_t frameIndex, int64_t wallMs);
+
+	uint64_t written() const { return m_written.load(std::memory_order_relaxed); }
+	uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+	void run();
+
+	std::FILE*                    m_file = nullptr;
+	size_t                        m_batch;
+	BoundedQueue<DetectionRecord> m_queue;
+
+	std::atomic<uint64_t> m_written{ 0 };
+	std::atomic<uint64_t> m_dropped{ 0 };
+	std::jthread          m_thread;
+};
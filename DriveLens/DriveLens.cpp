@@ -5,63 +5,56 @@
 // The edge device captures, uploads, parses results, and draws overlays.
 //
 // Usage:
-//   DriveLens.exe              -> open default webcam (device 0)
-//   DriveLens.exe video.mp4    -> read from a video file
+//   DriveLens.exe                      -> open default webcam (device 0)
+//   DriveLens.exe video.mp4            -> read from a video file
+//   DriveLens.exe --batch video.mp4    -> headless, as fast as the server allows
+//
+// Threads: capture (cv::VideoCapture -> FrameRing), pipeline/display (main),
+// and UPLOAD_IN_FLIGHT encode + upload workers.
 
 #include "DriveLens.h"
 #include "config.h"
-
-using json = nlohmann::json;
-
-// ── Detection data parsed from the server JSON response ──────────────
-struct Detection {
-	std::string name;
-	double      confidence;
-	int         x_min, y_min, x_max, y_max;
+#include "FrameRing.h"
+#include "UploadClient.h"
+#include "BufferPool.h"
+#include "UploadWorkers.h"
+#include "CaptureGate.h"
+#include "Detection.h"
+#include "LabelSprites.h"
+#include "JpegEncoder.h"
+#include "QualityController.h"
+#include "UploadRegion.h"
+#include "UploadSpool.h"
+#include "SpoolDrainer.h"
+#include "DebugFrameWriter.h"
+#include "DetectionLog.h"
+#include "LatencyStats.h"
+#include "MetricsServer.h"
+#include "CloudResponse.h"
+#include "ObjectTracker.h"
+#include "LocalDetector.h"
+#include "InferencePolicy.h"
+
+#include <fstream>
+
+// ── PipelineCounters ─────────────────────────────────────────────────
+// Counters kept by the pipeline and upload threads for the stats line and
+// the metrics endpoint; relaxed atomics, so a scrape never blocks a writer.
+struct PipelineCounters {
+	std::atomic<uint64_t> framesDisplayed{ 0 };
+	std::atomic<uint64_t> windowSkipped{ 0 };   // samples skipped: window full
+	std::atomic<uint64_t> staleResults{ 0 };    // results older than lastDetection
+	std::atomic<uint64_t> uploadsOk{ 0 };
+	std::atomic<uint64_t> uploadsFailed{ 0 };
+	std::atomic<uint64_t> bytesSent{ 0 };       // JPEG bytes of every upload attempt
 };
 
-struct CloudResult {
-	std::vector<Detection> objects;
-	int                    imageWidth  = RESIZE_WIDTH;
-	int                    imageHeight = RESIZE_HEIGHT;
-};
-
-// ── parseCloudResponse ───────────────────────────────────────────────
-static CloudResult parseCloudResponse(const std::string& jsonStr)
-{
-	CloudResult result;
-	if (jsonStr.empty()) return result;
-
-	try {
-		auto j = json::parse(jsonStr);
-
-		result.imageWidth  = j.value("image_width",  RESIZE_WIDTH);
-		result.imageHeight = j.value("image_height", RESIZE_HEIGHT);
-
-		if (j.contains("detected_objects") && j["detected_objects"].is_array()) {
-			for (auto& obj : j["detected_objects"]) {
-				Detection det;
-				det.name       = obj.value("name", "unknown");
-				det.confidence = obj.value("confidence", 0.0);
-				det.x_min      = obj.value("x_min", 0);
-				det.y_min      = obj.value("y_min", 0);
-				det.x_max      = obj.value("x_max", 0);
-				det.y_max      = obj.value("y_max", 0);
-				result.objects.push_back(det);
-			}
-		}
-	} catch (const json::exception& e) {
-		std::cerr << "[JSON] Parse error: " << e.what() << std::endl;
-	}
-
-	return result;
-}
-
 // ── drawDetections ───────────────────────────────────────────────────
-// Draw bounding boxes and labels on the ORIGINAL frame, scaling
-// coordinates from the resized image back to the original resolution.
+// Draw bounding boxes and labels on the ORIGINAL frame. Results are in
+// frame pixels (mapToFrame); the scale only covers a frame of another size.
 static void drawDetections(cv::Mat& frame,
-						   const CloudResult& result)
+						   const CloudResult& result,
+						   LabelSprites& labels)
 {
 	double scaleX = static_cast<double>(frame.cols) / result.imageWidth;
 	double scaleY = static_cast<double>(frame.rows) / result.imageHeight;
@@ -76,76 +69,253 @@ static void drawDetections(cv::Mat& frame,
 		cv::rectangle(frame, cv::Point(x1, y1), cv::Point(x2, y2),
 					  cv::Scalar(0, 255, 0), 2);
 
-		// Label: object name only
-		std::string label = det.name;
-
-		int baseline = 0;
-		cv::Size textSize = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX,
-											0.5, 1, &baseline);
-		int labelY = std::max(y1 - 6, textSize.height + 4);
-		cv::rectangle(frame,
-					  cv::Point(x1, labelY - textSize.height - 4),
-					  cv::Point(x1 + textSize.width + 4, labelY + 2),
-					  cv::Scalar(0, 255, 0), cv::FILLED);
-		cv::putText(frame, label, cv::Point(x1 + 2, labelY - 2),
-					cv::FONT_HERSHEY_SIMPLEX, 0.5,
-					cv::Scalar(0, 0, 0), 1);
+		// Label: object name only, pre-rendered
+		labels.draw(frame, det.classId, x1, y1);
 	}
 }
 
 // ── encodeToJpeg ─────────────────────────────────────────────────────
-static bool encodeToJpeg(const cv::Mat& frame,
-						 std::vector<uchar>& buffer)
+// Runs on the upload workers; each keeps its own libjpeg compressor.
+static bool encodeToJpeg(const cv::Mat& frame, int quality, JpegBytes& buffer)
 {
-	std::vector<int> params = { cv::IMWRITE_JPEG_QUALITY, JPEG_QUALITY };
-	return cv::imencode(".jpg", frame, buffer, params);
+	thread_local JpegEncoder encoder;
+	return encoder.encode(frame, quality, buffer);
 }
 
-#ifdef DEBUG_SAVE_FRAMES
-static void debugSave(const cv::Mat& frame, const std::string& filename)
+// ── detectLocal ──────────────────────────────────────────────────────
+static CloudResult detectLocal(LocalDetector& detector, InferencePolicy& policy,
+							   LatencyStats& latency, const cv::Mat& image)
 {
-	std::filesystem::create_directories(DEBUG_OUTPUT_DIR);
-	std::string path = std::string(DEBUG_OUTPUT_DIR) + "/" + filename;
-	cv::imwrite(path, frame);
-	std::cout << "[Debug] Saved " << path << std::endl;
+	auto start = std::chrono::steady_clock::now();
+	CloudResult result = detector.detect(image);
+	auto elapsed = std::chrono::steady_clock::now() - start;
+	policy.recordLocal(std::chrono::duration<double, std::milli>(elapsed).count());
+	latency.record(Stage::Local, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+	return result;
+}
+
+// ── dumpLatency ──────────────────────────────────────────────────────
+// Rewrite the machine-readable per-stage histograms (totals since start).
+// Written to a temporary file and renamed over the old dump, so a reader
+// never sees a half-written one.
+static void dumpLatency(const LatencyStats::Snapshot& snap)
+{
+	std::string temp = std::string(LATENCY_DUMP_PATH) + ".tmp";
+	{
+		std::ofstream out(temp, std::ios::trunc);
+		out << LatencyStats::toJson(snap).dump(1) << '\n';
+		if (!out) {
+			std::cerr << "[Latency] Cannot write " << temp << std::endl;
+			return;
+		}
+	}
+	std::error_code ec;
+	std::filesystem::rename(temp, LATENCY_DUMP_PATH, ec);
+	if (ec) std::cerr << "[Latency] Cannot write " << LATENCY_DUMP_PATH << ": " << ec.message() << std::endl;
+}
+
+// ── spoolJob ─────────────────────────────────────────────────────────
+// Keep the encoded main image for replay. Tiles are not spooled: the full
+// view is what the server stores per capture.
+static void spoolJob(UploadSpool& spool, const UploadJob& job)
+{
+	if (!spool.available() || job.buffer->jpeg.empty()) return;
+
+	SpoolRecord record;
+	record.captureIndex = job.captureIndex;
+	record.frameIndex   = static_cast<int64_t>(job.frameIndex);
+	record.captureNs    = job.captureNs;
+	record.wallMs       = wallClockMs(job.captureNs);   // names the frame after a restart
+	if (spool.append(record, job.buffer->jpeg))
+		std::cout << "[Spool] Queued " << job.filename << " for replay" << std::endl;
 }
-#endif
 
-// ── uploadFrame ──────────────────────────────────────────────────────
-static std::string uploadFrame(const std::vector<uchar>& jpegBuffer,
-							   const std::string& filename)
+// ── echoMatches ──────────────────────────────────────────────────────
+// The server echoes the frame_index / capture_ns it was sent. A result
+// carrying another frame's values (a proxy or pooled connection mixing up
+// responses) must not be drawn over this one; fields not echoed pass.
+static bool echoMatches(const std::vector<CloudResult>& results, const UploadJob& job)
 {
-	std::string body(jpegBuffer.begin(), jpegBuffer.end());
-	cpr::Response res = cpr::Post(
-		cpr::Url{ API_ENDPOINT },
-		cpr::Multipart{
-			{ "file", cpr::Buffer{ body.begin(), body.end(), filename } }
-		},
-		cpr::Timeout{ UPLOAD_TIMEOUT_MS }
-	);
-
-	if (res.status_code == 200) {
-		std::cout << "[Upload] " << filename
-				  << "  OK (" << jpegBuffer.size() << " bytes)" << std::endl;
-		return res.text;
+	for (const CloudResult& result : results) {
+		if (result.frameIndex >= 0 &&
+			result.frameIndex != static_cast<int64_t>(job.frameIndex)) return false;
+		if (result.captureNs != 0 && result.captureNs != job.captureNs) return false;
+	}
+	return true;
+}
+
+// ── prepareUpload ────────────────────────────────────────────────────
+// Copy the uploaded region of `frame` into the leased buffer at the size
+// the quality controller asks for, and describe the job for the workers.
+// A tiled upload adds its grid to the buffer's tiles.
+static UploadJob prepareUpload(const cv::Mat& frame, uint64_t captureIndex,
+							   const FrameInfo& info, BufferPool::Lease buffer,
+							   const QualityController& uploadQuality,
+							   LatencyStats& latency)
+{
+	LatencyStats::Scope timer(latency, Stage::Resize);
+	QualityController::Settings sizing = uploadQuality.current();
+	cv::Rect region = uploadRegion(frame.size(), captureIndex);
+	cv::resize(frame(region), buffer->resized,
+			   uploadSize(frame.size(), region, sizing, ROI_MAX_WIDTH));
+
+	buffer->tiles.resize(TILED_UPLOADS ? TILE_COLS * TILE_ROWS : 0);
+	for (size_t i = 0; i < buffer->tiles.size(); ++i) {
+		EncodeTile& tile = buffer->tiles[i];
+		tile.region = tileRegion(frame.size(), static_cast<int>(i));
+		cv::resize(frame(tile.region), tile.image,
+				   uploadSize(frame.size(), tile.region, sizing, TILE_MAX_WIDTH));
+	}
+
+	UploadJob job;
+	job.captureIndex = captureIndex;
+	job.frameIndex   = info.index;
+	job.captureNs    = info.captureNs;
+	job.buffer       = std::move(buffer);
+	job.filename     = "frame_" + std::to_string(captureIndex) + ".jpg";
+	job.quality      = sizing.quality;
+	job.rung         = sizing.rung;
+	job.region       = region;
+	job.frameSize    = frame.size();
+	return job;
+}
+
+// ── captureLoop ──────────────────────────────────────────────────────
+// Runs on its own thread and decodes frames straight into the ring so a
+// slow encode or window repaint never stalls the camera. A live camera
+// keeps grabbing (and drops) frames while the ring is full; a video file
+// waits instead, so every frame of the file is still shown.
+static void captureLoop(std::stop_token stop,
+						cv::VideoCapture& cap,
+						FrameRing& ring,
+						bool isVideoFile,
+						std::atomic<bool>& sourceEnded,
+						LatencyStats& latency)
+{
+	uint64_t frameIndex = 0;
+
+	while (!stop.stop_requested()) {
+		cv::Mat* slot = ring.acquireWrite();
+		if (!slot) {
+			if (isVideoFile) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				continue;
+			}
+			if (!cap.grab()) break;
+			ring.noteDropped();
+			++frameIndex;
+			continue;
+		}
+
+		{
+			LatencyStats::Scope timer(latency, Stage::Capture);
+			if (!cap.read(*slot) || slot->empty()) break;
+		}
+		ring.publish(FrameInfo{ frameIndex++, monotonicNs() });
 	}
 
-	std::cerr << "[Upload] " << filename
-			  << "  FAILED  status=" << res.status_code
-			  << "  error=" << res.error.message << std::endl;
-	return "";
+	sourceEnded.store(true, std::memory_order_release);
+}
+
+// ── runBatch ─────────────────────────────────────────────────────────
+// Headless mode for archived footage: no window and no wall-clock pacing.
+// Frames the capture gate does not probe are only grabbed, never converted
+// to BGR, and decoding the next sample overlaps with encode/upload of
+// earlier ones.
+// When the in-flight window is full the loop waits instead of skipping the
+// sample, so the run goes exactly as fast as the server takes frames.
+static uint64_t runBatch(cv::VideoCapture& cap, double fps, CaptureGate& gate,
+						 BufferPool& encodeBuffers, QualityController& uploadQuality,
+						 UploadWorkers& uploads, LatencyStats& latency)
+{
+	auto report = [](const UploadResult& done) {
+		std::cout << "[Detect] frame_" << done.captureIndex << ": "
+				  << done.result.objects.size() << " object(s) found" << std::endl;
+	};
+
+	cv::Mat  frame;
+	uint64_t frameIndex   = 0;
+	uint64_t captureIndex = 0;
+	auto     start        = std::chrono::steady_clock::now();
+
+	for (; cap.grab(); ++frameIndex) {
+		if (!gate.probeDue(frameIndex)) continue;
+
+		bool decoded;
+		{
+			LatencyStats::Scope timer(latency, Stage::Capture);
+			decoded = cap.retrieve(frame) && !frame.empty();
+		}
+		if (!decoded) {
+			std::cerr << "[Error] Failed to decode frame " << frameIndex << std::endl;
+			continue;
+		}
+		int64_t captureNs = monotonicNs();
+		if (!gate.evaluate(frame, frameIndex)) continue;
+
+		// Wait for room in the window instead of dropping the sample
+		UploadResult done;
+		while (uploads.inFlight() >= uploads.window()) {
+			uploads.wait(done);
+			report(done);
+		}
+		while (uploads.poll(done)) report(done);
+
+		BufferPool::Lease buffer = encodeBuffers.tryAcquire();
+		if (!buffer) {
+			std::cerr << "[Error] No encode buffer for frame " << frameIndex << std::endl;
+			continue;
+		}
+		UploadJob job = prepareUpload(frame, captureIndex, FrameInfo{ frameIndex, captureNs },
+									  std::move(buffer), uploadQuality, latency);
+		if (uploads.trySubmit(std::move(job))) {
+			gate.accept(frameIndex);
+			++captureIndex;
+		}
+	}
+
+	// Drain the window
+	UploadResult done;
+	while (uploads.inFlight() > 0) {
+		uploads.wait(done);
+		report(done);
+	}
+
+	double elapsed = std::chrono::duration<double>(
+		std::chrono::steady_clock::now() - start).count();
+	double videoSec = frameIndex / fps;
+	std::cout << "[Batch] " << frameIndex << " frames (" << videoSec << "s of video) in "
+			  << elapsed << "s  |  " << (elapsed > 0 ? videoSec / elapsed : 0.0)
+			  << "x realtime  |  " << captureIndex << " uploaded, "
+			  << gate.gated() << " probes gated" << std::endl;
+
+	return captureIndex;
 }
 
 // ── Main ─────────────────────────────────────────────────────────────
 int main(int argc, char* argv[])
 {
 	try {
+		// --- Parse arguments ---
+		std::string videoPath;
+		bool batchMode = false;
+
+		for (int i = 1; i < argc; ++i) {
+			std::string arg = argv[i];
+			if (arg == "--batch") batchMode = true;
+			else                  videoPath = arg;
+		}
+
+		if (batchMode && videoPath.empty()) {
+			std::cerr << "[Error] --batch requires a video file." << std::endl;
+			return 1;
+		}
+
 		// --- Open video source ---
 		cv::VideoCapture cap;
 		bool isVideoFile = false;
 
-		if (argc >= 2) {
-			std::string videoPath = argv[1];
+		if (!videoPath.empty()) {
 			cap.open(videoPath);
 			isVideoFile = true;
 			std::cout << "[DriveLens] Opening video file: " << videoPath << std::endl;
@@ -162,97 +332,414 @@ int main(int argc, char* argv[])
 		double fps = cap.get(cv::CAP_PROP_FPS);
 		if (fps <= 0) fps = 30.0;
 
-		int frameSkip = static_cast<int>(fps * CAPTURE_INTERVAL_SEC);
-		std::cout << "[DriveLens] FPS: " << fps
-				  << "  |  Capture every " << frameSkip << " frames ("
-				  << CAPTURE_INTERVAL_SEC << "s)" << std::endl;
+		std::cout << "[DriveLens] FPS: " << fps << "  |  Capture ";
+		if (CAPTURE_CHANGE_GATED)
+			std::cout << "on scene change, every " << CAPTURE_MIN_MS << "-"
+					  << CAPTURE_MAX_MS << " ms" << std::endl;
+		else
+			std::cout << "every " << CAPTURE_INTERVAL_SEC << "s" << std::endl;
+
+		// Chooses which frames are uploaded
+		CaptureGate gate(fps);
+
+		// Persistent keep-alive connections to the cloud endpoint
+		UploadClient uploader(API_ENDPOINT, UPLOAD_POOL_SIZE, UPLOAD_TIMEOUT_MS);
+
+		// Reusable resize/encode buffers, returned when each upload finishes
+		BufferPool encodeBuffers(ENCODE_BUFFER_COUNT, ENCODE_RESERVE_BYTES);
+
+		// Upload size / quality, adapted to the measured round trip
+		QualityController uploadQuality;
+
+		// Per-stage latency histograms
+		LatencyStats latency;
+
+		// On-device fallback detector (not used for --batch: that footage is
+		// meant for the server) and the cloud/local routing policy
+		LocalDetector localDetector(LOCAL_FALLBACK && !batchMode ? LOCAL_MODEL_PATH : "");
+		InferencePolicy policy(localDetector.available());
+		if (localDetector.available()) {
+			// Warm up and get a first local latency estimate
+			cv::Mat blank(RESIZE_HEIGHT, RESIZE_WIDTH, CV_8UC3, cv::Scalar::all(0));
+			detectLocal(localDetector, policy, latency, blank);
+			std::cout << "[Local] Inference ~" << policy.localMs() << " ms" << std::endl;
+		}
 
-		// --- Main capture loop ---
-		cv::Mat frame, displayFrame, resized;
-		std::vector<uchar> jpegBuffer;
-		int frameCount   = 0;
-		int captureIndex = 0;
+		// Shared by the pipeline loop, the workers and the metrics endpoint
+		PipelineCounters counters;
 
-		// Last detection results – drawn on every frame until updated
-		CloudResult lastDetection;
+		// Local history of every detection
+		DetectionLog detectionLog(DETECTION_LOG_PATH, DETECTION_LOG_QUEUE, DETECTION_LOG_BATCH);
 
-		// Async upload state – keeps video playing during HTTP POST
-		std::future<std::string> pendingUpload;
-		bool uploadInFlight = false;
+		// Frames the cloud did not get now, replayed in the background
+		UploadSpool  spool(SPOOL_ENABLED ? SPOOL_DIR : "", SPOOL_SEGMENT_BYTES, SPOOL_MAX_BYTES);
+		SpoolDrainer drainer(spool, uploader);
 
-		while (true) {
-			if (!cap.read(frame) || frame.empty()) {
-				if (isVideoFile)
-					std::cout << "[DriveLens] End of video." << std::endl;
-				else
-					std::cerr << "[Error] Failed to read frame." << std::endl;
-				break;
+#ifdef DEBUG_SAVE_FRAMES
+		// Uploaded JPEGs, archived as-is off the upload path
+		DebugFrameWriter debugFrames(DEBUG_OUTPUT_DIR, DEBUG_ARCHIVE_BYTES,
+									 DEBUG_QUEUE_DEPTH, ENCODE_RESERVE_BYTES);
+#endif
+
+		// Detection for one job, in upload-image pixels: the main image's
+		// result first, then one per tile when the cloud answered them all
+		auto detectJob = [&](UploadJob& job) {
+			std::vector<CloudResult> results;
+			const cv::Mat& image = job.buffer->resized;
+			if (policy.chooseLocal()) {
+				results.push_back(detectLocal(localDetector, policy, latency, image));
+				// While the cloud is down the frame is deferred, not dropped.
+				// A cloud that is only slower than local is not fed replays
+				// over the same slow link.
+				if (spool.available() && policy.cloudFailing() &&
+					encodeToJpeg(image, job.quality, job.buffer->jpeg))
+					spoolJob(spool, job);
+				return results;
 			}
 
-			// Check if a background upload has finished (non-blocking)
-			if (uploadInFlight &&
-				pendingUpload.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready)
+			bool   encoded;
+			size_t bytes;
 			{
-				std::string cloudResponse = pendingUpload.get();
-				uploadInFlight = false;
+				LatencyStats::Scope timer(latency, Stage::Encode);
+				encoded = encodeToJpeg(image, job.quality, job.buffer->jpeg);
+				bytes   = job.buffer->jpeg.size();
+				for (EncodeTile& tile : job.buffer->tiles) {
+					encoded = encoded && encodeToJpeg(tile.image, job.quality, tile.jpeg);
+					bytes  += tile.jpeg.size();
+				}
+			}
+			if (!encoded) {
+				std::cerr << "[Error] JPEG encode failed for frame "
+						  << job.captureIndex << std::endl;
+				return results;
+			}
+#ifdef DEBUG_SAVE_FRAMES
+			debugFrames.save(job.captureIndex, wallClockMs(job.captureNs), job.buffer->jpeg);
+#endif
+			FormFields fields = {
+				{ "frame_index", std::to_string(job.frameIndex) },
+				{ "capture_ns",  std::to_string(job.captureNs) }
+			};
+			auto start = std::chrono::steady_clock::now();
+			std::string response;
+			if (job.buffer->tiles.empty()) {
+				response = uploader.upload(job.buffer->jpeg, job.filename, fields);
+			} else {
+				std::vector<UploadFile> files;
+				files.reserve(job.buffer->tiles.size() + 1);
+				files.push_back({ job.buffer->jpeg, job.filename });
+				for (size_t i = 0; i < job.buffer->tiles.size(); ++i)
+					files.push_back({ job.buffer->tiles[i].jpeg,
+									  "frame_" + std::to_string(job.captureIndex)
+									  + "_t" + std::to_string(i) + ".jpg" });
+				response = uploader.uploadTiles(files, fields);
+			}
+			auto elapsed = std::chrono::steady_clock::now() - start;
+			latency.record(Stage::Upload,
+						   std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+			double elapsedMs = std::chrono::duration<double, std::milli>(elapsed).count();
+			policy.recordCloud(!response.empty(), elapsedMs);
+			counters.bytesSent.fetch_add(bytes, std::memory_order_relaxed);
+			(response.empty() ? counters.uploadsFailed : counters.uploadsOk)
+				.fetch_add(1, std::memory_order_relaxed);
+			uploadQuality.record(job.rung, !response.empty(), bytes, elapsedMs);
+
+			if (!response.empty()) {
+				{
+					LatencyStats::Scope timer(latency, Stage::Parse);
+					if (job.buffer->tiles.empty()) results.push_back(parseCloudResponse(response));
+					else                           results = parseCloudResponseTiles(response);
+				}
+				if (results.size() != job.buffer->tiles.size() + 1)
+					std::cerr << "[Error] Expected " << job.buffer->tiles.size() + 1
+							  << " tile results for frame " << job.captureIndex
+							  << ", got " << results.size() << std::endl;
+				else if (!echoMatches(results, job))
+					std::cerr << "[Error] Response for frame " << results.front().frameIndex
+							  << " arrived on the upload of frame " << job.frameIndex << std::endl;
+				else
+					return results;
+				results.clear();
+			} else {
+				spoolJob(spool, job);
+			}
 
-				lastDetection = parseCloudResponse(cloudResponse);
+			// Cloud failed: keep the overlay alive with a local result
+			if (localDetector.available())
+				results.push_back(detectLocal(localDetector, policy, latency, image));
+			return results;
+		};
+
+		// Detection workers – keep video playing during HTTP POSTs. Results
+		// leave the worker in frame pixels, whatever region was uploaded,
+		// with tiles merged into one, and are logged.
+		UploadWorkers uploads(UPLOAD_IN_FLIGHT,
+			[&detectJob, &detectionLog](UploadJob& job) -> CloudResult {
+				std::vector<CloudResult> results = detectJob(job);
+				for (size_t i = 0; i < results.size(); ++i)
+					mapToFrame(results[i],
+							   i == 0 ? job.region : job.buffer->tiles[i - 1].region,
+							   job.frameSize);
+				CloudResult merged = mergeTiles(results);
+				detectionLog.log(merged, job.frameIndex, wallClockMs(job.captureNs));
+				return merged;
+			});
+
+		if (batchMode) {
+			uint64_t uploaded = runBatch(cap, fps, gate, encodeBuffers, uploadQuality,
+										 uploads, latency);
+			uploads.shutdown();
+			cap.release();
+			LatencyStats::Snapshot total = latency.snapshot();
+			std::cout << "[Latency]" << LatencyStats::summary(total) << std::endl;
+			dumpLatency(total);
+			std::cout << "[DriveLens] Done. Uploaded " << uploaded
+					  << " frames." << std::endl;
+			return 0;
+		}
+
+		// --- Capture thread -> frame ring -> display / upload ---
+		FrameRing ring(FRAME_RING_CAPACITY);
+		std::atomic<bool> sourceEnded{ false };
+		std::jthread captureThread(captureLoop, std::ref(cap), std::ref(ring),
+								   isVideoFile, std::ref(sourceEnded), std::ref(latency));
+
+		// --- Metrics endpoint (live mode) ---
+		// Runs on its own thread. Every counter read here, the spool backlog
+		// included, is a relaxed atomic. latency.snapshot() locks only
+		// against thread registration, which the loops do once, on their
+		// first sample.
+		MetricsServer metrics(METRICS_PORT, [&]() {
+			PrometheusText text;
+			text.family("drivelens_frames_total", "counter", "Frames by pipeline stage.");
+			text.sample("drivelens_frames_total", static_cast<double>(ring.published()), "stage=\"captured\"");
+			text.sample("drivelens_frames_total", static_cast<double>(ring.dropped()), "stage=\"dropped\"");
+			text.sample("drivelens_frames_total", static_cast<double>(ring.overwritten()), "stage=\"overwritten\"");
+			text.sample("drivelens_frames_total",
+						static_cast<double>(counters.framesDisplayed.load(std::memory_order_relaxed)),
+						"stage=\"displayed\"");
+
+			text.family("drivelens_samples_skipped_total", "counter",
+						"Upload samples not taken, by reason.");
+			text.sample("drivelens_samples_skipped_total",
+						static_cast<double>(counters.windowSkipped.load(std::memory_order_relaxed)),
+						"reason=\"window_full\"");
+			text.sample("drivelens_samples_skipped_total", static_cast<double>(gate.gated()),
+						"reason=\"scene_unchanged\"");
+
+			text.family("drivelens_results_stale_total", "counter",
+						"Results discarded because a newer one was already shown.");
+			text.sample("drivelens_results_stale_total",
+						static_cast<double>(counters.staleResults.load(std::memory_order_relaxed)));
+
+			text.family("drivelens_uploads_in_flight", "gauge", "Uploads being encoded or sent.");
+			text.sample("drivelens_uploads_in_flight", static_cast<double>(uploads.inFlight()));
+			text.family("drivelens_uploads_total", "counter", "Finished cloud uploads by result.");
+			text.sample("drivelens_uploads_total",
+						static_cast<double>(counters.uploadsOk.load(std::memory_order_relaxed)),
+						"result=\"ok\"");
+			text.sample("drivelens_uploads_total",
+						static_cast<double>(counters.uploadsFailed.load(std::memory_order_relaxed)),
+						"result=\"failed\"");
+			text.family("drivelens_upload_bytes_total", "counter", "JPEG bytes sent to the cloud.");
+			text.sample("drivelens_upload_bytes_total",
+						static_cast<double>(counters.bytesSent.load(std::memory_order_relaxed)));
+
+			text.family("drivelens_spool_pending_bytes", "gauge", "Spooled bytes awaiting replay.");
+			text.sample("drivelens_spool_pending_bytes", static_cast<double>(spool.pendingBytes()));
+			text.family("drivelens_spool_replayed_total", "counter", "Spooled frames replayed.");
+			text.sample("drivelens_spool_replayed_total", static_cast<double>(spool.replayed()));
+
+			QualityController::Settings sizing = uploadQuality.current();
+			text.family("drivelens_capture_interval_seconds", "gauge",
+						"Interval between the last two uploaded samples.");
+			text.sample("drivelens_capture_interval_seconds", gate.lastIntervalMs() / 1000.0);
+			text.family("drivelens_jpeg_quality", "gauge", "Current upload JPEG quality.");
+			text.sample("drivelens_jpeg_quality", sizing.quality);
+			text.family("drivelens_upload_width_pixels", "gauge", "Current upload image width.");
+			text.sample("drivelens_upload_width_pixels", sizing.size.width);
+			text.family("drivelens_inference_local", "gauge", "1 while detection runs on the device.");
+			text.sample("drivelens_inference_local", policy.usingLocal() ? 1.0 : 0.0);
+
+			LatencyStats::Snapshot snap = latency.snapshot();
+			text.family("drivelens_stage_latency_seconds", "histogram",
+						"Duration of each pipeline stage.");
+			for (int s = 0; s < LatencyStats::STAGES; ++s)
+				text.histogram("drivelens_stage_latency_seconds", snap.stages[s],
+							   std::string("stage=\"") + stageName(static_cast<Stage>(s)) + "\"");
+			return text.str();
+		});
+
+		// --- Latency dump: the file I/O stays off the display thread ---
+		std::jthread latencyDumper([&latency](std::stop_token stop) {
+			std::mutex                  mutex;
+			std::condition_variable_any wake;
+			std::unique_lock lock(mutex);
+			while (!wake.wait_for(lock, stop, std::chrono::seconds(STATS_INTERVAL_SEC),
+								  [] { return false; }) && !stop.stop_requested())
+				dumpLatency(latency.snapshot());
+		});
+
+		// --- Main pipeline loop ---
+		uint64_t captureIndex    = 0;
+
+		// Last detection results – followed by the tracker on every frame
+		// until the next cloud result replaces them
+		CloudResult   lastDetection;
+		int64_t       lastAppliedCapture = -1;
+		ObjectTracker tracker;
+		LabelSprites  labels;
+
+		auto lastStats = std::chrono::steady_clock::now();
+		LatencyStats::Snapshot lastLatency;
+
+		while (true) {
+			// Read the flag first: once set, an empty ring means no more frames
+			bool ended = sourceEnded.load(std::memory_order_acquire);
+
+			FrameInfo info;
+			cv::Mat* frame = isVideoFile ? ring.front(&info)
+										 : ring.latest(&info);
+			if (!frame) {
+				if (ended) {
+					if (isVideoFile)
+						std::cout << "[DriveLens] End of video." << std::endl;
+					else
+						std::cerr << "[Error] Failed to read frame." << std::endl;
+					break;
+				}
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				continue;
+			}
+
+			// Apply finished uploads (non-blocking). Responses can arrive out
+			// of order; one older than what is already shown is discarded.
+			UploadResult done;
+			bool reseeded = false;
+			while (uploads.poll(done)) {
+				if (static_cast<int64_t>(done.captureIndex) < lastAppliedCapture) {
+					counters.staleResults.fetch_add(1, std::memory_order_relaxed);
+					continue;
+				}
+				lastAppliedCapture = static_cast<int64_t>(done.captureIndex);
+
+				// A band result leaves the rest of the frame as shown: keep
+				// those boxes (tracked positions, if tracking) until the next
+				// full view
+				bool band = done.region.area() < frame->cols * frame->rows;
+				if (band) {
+					const CloudResult& before = TRACK_ENABLED && !reseeded ? tracker.current()
+																		   : lastDetection;
+					keepOutside(done.result, before, done.region);
+				}
+				lastDetection = std::move(done.result);
+				reseeded = true;
 
 				if (!lastDetection.objects.empty()) {
 					std::cout << "[Detect] " << lastDetection.objects.size()
-							  << " object(s) found" << std::endl;
+							  << " object(s) found  (age "
+							  << (monotonicNs() - done.captureNs) / 1000000 << " ms)"
+							  << std::endl;
 				}
 			}
 
-			// Draw detections on a COPY – keep original frame clean for upload
-			displayFrame = frame.clone();
-			if (!lastDetection.objects.empty()) {
-				drawDetections(displayFrame, lastDetection);
+			// Move the boxes with the scene (needs the slot, before pop). A new
+			// result is projected from its capture frame to this one.
+			if (TRACK_ENABLED) {
+				if (reseeded) tracker.reseed(lastDetection, lastAppliedCapture, *frame);
+				else          tracker.update(*frame);
 			}
+			const CloudResult& shown = TRACK_ENABLED ? tracker.current() : lastDetection;
 
-			cv::imshow("DriveLens Dashcam", displayFrame);
-			if (cv::waitKey(1) == 27) break;
-
-			++frameCount;
-			if (frameCount % frameSkip != 0) continue;
-
-			// Skip this capture if a previous upload is still in progress
-			if (uploadInFlight) continue;
+			// --- Hand a resized CLEAN frame to the upload stage ---
+			// Only when the scene gate asks for it and the window has room
+			bool sampleDue = gate.probeDue(info.index) && gate.evaluate(*frame, info.index);
 
-			// --- Resize the CLEAN frame for upload ---
-			cv::resize(frame, resized, cv::Size(RESIZE_WIDTH, RESIZE_HEIGHT));
+			BufferPool::Lease buffer;
+			if (sampleDue) {
+				if (uploads.inFlight() < uploads.window())
+					buffer = encodeBuffers.tryAcquire();
+				else
+					counters.windowSkipped.fetch_add(1, std::memory_order_relaxed);
+			}
 
-			// --- Encode to JPEG ---
-			if (!encodeToJpeg(resized, jpegBuffer)) {
-				std::cerr << "[Error] JPEG encode failed for frame "
-						  << captureIndex << std::endl;
-				continue;
+			if (buffer) {
+				// Encode + upload run on a worker; the buffer goes back to
+				// the pool when the job finishes
+				UploadJob job = prepareUpload(*frame, captureIndex, info,
+											  std::move(buffer), uploadQuality, latency);
+				if (uploads.trySubmit(std::move(job))) {
+					gate.accept(info.index);
+					if (TRACK_ENABLED) tracker.remember(captureIndex, *frame);
+					++captureIndex;
+				}
 			}
 
-			std::string filename = "frame_" + std::to_string(captureIndex) + ".jpg";
+			// Everything that needs clean pixels (tracker, gate, upload resize,
+			// tracker snapshot) is done: draw straight into the slot instead of
+			// cloning the frame. imshow copies into the window's own buffer, so
+			// the slot goes back to the capture thread before the repaint.
+			if (!shown.objects.empty()) {
+				LatencyStats::Scope timer(latency, Stage::Draw);
+				drawDetections(*frame, shown, labels);
+			}
 
-#ifdef DEBUG_SAVE_FRAMES
-			debugSave(resized, filename);
-#endif
+			cv::imshow("DriveLens Dashcam", *frame);
+			ring.pop();
+			counters.framesDisplayed.fetch_add(1, std::memory_order_relaxed);
 
-			// --- Launch upload in background thread ---
-			std::vector<uchar> bufferCopy = jpegBuffer;
-			pendingUpload = std::async(std::launch::async,
-				uploadFrame, std::move(bufferCopy), filename);
-			uploadInFlight = true;
+			if (cv::waitKey(1) == 27) break;
 
-			++captureIndex;
+			auto now = std::chrono::steady_clock::now();
+			if (now - lastStats >= std::chrono::seconds(STATS_INTERVAL_SEC)) {
+				lastStats = now;
+				QualityController::Settings sizing = uploadQuality.current();
+				std::cout << "[Pipeline] captured=" << ring.published()
+						  << "  dropped=" << ring.dropped()
+						  << "  overwritten=" << ring.overwritten()
+						  << "  | buffers: high-water=" << encodeBuffers.highWater()
+						  << "/" << encodeBuffers.capacity()
+						  << "  exhausted=" << encodeBuffers.exhausted()
+						  << "  | uploads: in-flight=" << uploads.inFlight()
+						  << "/" << uploads.window()
+						  << "  window-skipped=" << counters.windowSkipped.load(std::memory_order_relaxed)
+						  << "  stale=" << counters.staleResults.load(std::memory_order_relaxed)
+						  << "  | gate: score=" << gate.lastScore()
+						  << "  gated=" << gate.gated()
+						  << "  | inference: " << (policy.usingLocal() ? "local" : "cloud")
+						  << "  cloud=" << policy.cloudMs() << "ms"
+						  << "  local=" << policy.localMs() << "ms"
+						  << "  | upload: " << sizing.size.width << "x" << sizing.size.height
+						  << " q" << sizing.quality
+						  << "  rtt=" << uploadQuality.rttMs() << "ms"
+						  << "  " << uploadQuality.throughputKBps() << "KB/s"
+						  << "  | spool: " << spool.pendingBytes() / 1024 << "KB pending"
+						  << "  replayed=" << spool.replayed()
+						  << "  rejected=" << spool.rejected()
+						  << "  dropped=" << spool.droppedBytes() / 1024 << "KB" << std::endl;
+
+				// Percentiles over this period; the dump holds the totals
+				LatencyStats::Snapshot snap = latency.snapshot();
+				std::cout << "[Latency]" << LatencyStats::summary(snap - lastLatency) << std::endl;
+				lastLatency = snap;
+			}
 		}
 
+		// Stop the capture thread before releasing the device
+		captureThread.request_stop();
+		captureThread.join();
+		latencyDumper.request_stop();
+		latencyDumper.join();
+
 		// Wait for any pending upload before cleanup
-		if (uploadInFlight) {
-			pendingUpload.wait();
-		}
+		uploads.shutdown();
 
 		cap.release();
 		cv::destroyAllWindows();
+		dumpLatency(latency.snapshot());
 		std::cout << "[DriveLens] Done. Uploaded " << captureIndex
-				  << " frames." << std::endl;
+				  << " frames  (ring: dropped=" << ring.dropped()
+				  << "  overwritten=" << ring.overwritten() << ")" << std::endl;
 
 	} catch (const std::exception& ex) {
 		std::cerr << "[Fatal] " << ex.what() << std::endl;
@@ -9,10 +9,24 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <array>
+#include <unordered_map>
 #include <vector>
 #include <stdexcept>
 #include <filesystem>
 #include <future>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <span>
+#include <utility>
+#include <type_traits>
+#include <functional>
+#include <cstdint>
 
 #include <opencv2/opencv.hpp>
 #include <cpr/cpr.h>
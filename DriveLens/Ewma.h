@@ -0,0 +1,11 @@
+// Ewma.h : Exponentially weighted moving average shared by the latency
+//          estimators (inference policy, upload quality ladder).
+
+#pragma once
+
+// An average of 0 means "no sample yet": the first sample is taken as is.
+// Each caller passes its own smoothing factor from config.h.
+inline double ewma(double average, double sample, double alpha)
+{
+	return average == 0.0 ? sample : average + alpha * (sample - average);
+}
@@ -0,0 +1,119 @@
+// FrameRing.h : Fixed-capacity single-producer / single-consumer ring of
+//               preallocated cv::Mat slots, shared between the capture
+//               thread (producer) and the display/upload pipeline (consumer).
+//
+// The producer decodes straight into a slot (cv::VideoCapture::read reuses
+// the slot's storage once its size is known), so steady-state capture does
+// not allocate. Indices are monotonically increasing counters; a slot is
+// owned by the producer until publish() and by the consumer until pop().
+// While it owns a slot the consumer may also write to it (the display loop
+// draws the overlay in place); the producer overwrites it on the next lap.
+
+#pragma once
+
+#include "DriveLens.h"
+
+// Per-slot capture metadata, written by the producer with the pixels.
+struct FrameInfo {
+	uint64_t index     = 0;   // frame number since capture start (counts drops)
+	int64_t  captureNs = 0;   // steady_clock time the frame was decoded
+};
+
+// Monotonic timestamp used for every capture-time stamp in the pipeline.
+inline int64_t monotonicNs()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Wall-clock (system_clock) milliseconds of a monotonicNs() stamp, for
+// records that outlive the process.
+inline int64_t wallClockMs(int64_t captureNs)
+{
+	int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+	return nowMs - (monotonicNs() - captureNs) / 1000000;
+}
+
+class FrameRing {
+public:
+	explicit FrameRing(size_t capacity)
+		: m_slots(capacity), m_info(capacity)
+	{
+		if (capacity < 2)
+			throw std::invalid_argument("FrameRing capacity must be >= 2");
+	}
+
+	FrameRing(const FrameRing&)            = delete;
+	FrameRing& operator=(const FrameRing&) = delete;
+
+	// ── Producer side (capture thread only) ──────────────────────────
+	// Returns the slot to write into, or nullptr when every slot is still
+	// waiting for the consumer.
+	cv::Mat* acquireWrite()
+	{
+		uint64_t head = m_head.load(std::memory_order_relaxed);
+		uint64_t tail = m_tail.load(std::memory_order_acquire);
+		if (head - tail >= m_slots.size()) return nullptr;
+		return &m_slots[head % m_slots.size()];
+	}
+
+	// Make the slot returned by acquireWrite() visible to the consumer.
+	void publish(const FrameInfo& info)
+	{
+		uint64_t head = m_head.load(std::memory_order_relaxed);
+		m_info[head % m_slots.size()] = info;
+		m_head.store(head + 1, std::memory_order_release);
+	}
+
+	// Record a frame the producer had to throw away because the ring was full.
+	void noteDropped() { m_dropped.fetch_add(1, std::memory_order_relaxed); }
+
+	// ── Consumer side (pipeline thread only) ─────────────────────────
+	// Oldest published frame, or nullptr when the ring is empty. The slot
+	// stays valid until pop().
+	cv::Mat* front(FrameInfo* info = nullptr)
+	{
+		uint64_t tail = m_tail.load(std::memory_order_relaxed);
+		uint64_t head = m_head.load(std::memory_order_acquire);
+		if (tail == head) return nullptr;
+		if (info) *info = m_info[tail % m_slots.size()];
+		return &m_slots[tail % m_slots.size()];
+	}
+
+	// Newest published frame. Older frames that were never consumed are
+	// released back to the producer and counted as overwritten.
+	cv::Mat* latest(FrameInfo* info = nullptr)
+	{
+		uint64_t tail = m_tail.load(std::memory_order_relaxed);
+		uint64_t head = m_head.load(std::memory_order_acquire);
+		if (tail == head) return nullptr;
+		if (head - tail > 1) {
+			m_overwritten.fetch_add(head - tail - 1, std::memory_order_relaxed);
+			m_tail.store(head - 1, std::memory_order_release);
+		}
+		return front(info);
+	}
+
+	// Hand the slot returned by front()/latest() back to the producer.
+	void pop()
+	{
+		m_tail.store(m_tail.load(std::memory_order_relaxed) + 1,
+					 std::memory_order_release);
+	}
+
+	// ── Statistics (any thread) ──────────────────────────────────────
+	size_t   capacity()    const { return m_slots.size(); }
+	uint64_t published()   const { return m_head.load(std::memory_order_relaxed); }
+	uint64_t dropped()     const { return m_dropped.load(std::memory_order_relaxed); }
+	uint64_t overwritten() const { return m_overwritten.load(std::memory_order_relaxed); }
+
+private:
+	std::vector<cv::Mat>   m_slots;
+	std::vector<FrameInfo> m_info;     // capture metadata per slot
+
+	alignas(64) std::atomic<uint64_t> m_head{ 0 };   // written by producer
+	alignas(64) std::atomic<uint64_t> m_tail{ 0 };   // written by consumer
+	alignas(64) std::atomic<uint64_t> m_dropped{ 0 };
+	std::atomic<uint64_t>             m_overwritten{ 0 };
+};
@@ -0,0 +1,72 @@
+// InferencePolicy.cpp : Cloud / local routing based on measured latency.
+
+#include "InferencePolicy.h"
+#include "config.h"
+#include "Ewma.h"
+
+InferencePolicy::InferencePolicy(bool localAvailable)
+	: m_localAvailable(localAvailable)
+{
+}
+
+bool InferencePolicy::localPreferredLocked() const
+{
+	if (!m_localAvailable) return false;
+	if (m_failures >= FALLBACK_FAILURES) return true;
+	return m_cloudMs > CLOUD_SLOW_MS && m_localMs > 0.0 && m_cloudMs > m_localMs;
+}
+
+bool InferencePolicy::chooseLocal()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto now = std::chrono::steady_clock::now();
+
+	bool local = localPreferredLocked();
+	if (local && now - m_lastCloudAttempt >= std::chrono::milliseconds(CLOUD_PROBE_MS))
+		local = false;   // probe the cloud with this frame
+
+	if (!local) m_lastCloudAttempt = now;
+
+	bool preferred = localPreferredLocked();
+	if (m_usingLocal.exchange(preferred, std::memory_order_relaxed) != preferred) {
+		std::cout << "[Policy] Switching to " << (preferred ? "LOCAL" : "CLOUD")
+				  << " inference  (cloud " << m_cloudMs << " ms, local "
+				  << m_localMs << " ms, failures " << m_failures << ")" << std::endl;
+	}
+	return local;
+}
+
+void InferencePolicy::recordCloud(bool ok, double elapsedMs)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (ok) {
+		m_failures = 0;
+		m_cloudMs  = ewma(m_cloudMs, elapsedMs, POLICY_EWMA_ALPHA);
+	} else {
+		++m_failures;
+	}
+}
+
+void InferencePolicy::recordLocal(double elapsedMs)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_localMs = ewma(m_localMs, elapsedMs, POLICY_EWMA_ALPHA);
+}
+
+bool InferencePolicy::cloudFailing() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_failures >= FALLBACK_FAILURES;
+}
+
+double InferencePolicy::cloudMs() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_cloudMs;
+}
+
+double InferencePolicy::localMs() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_localMs;
+}
@@ -0,0 +1,41 @@
+// InferencePolicy.h : Chooses between cloud upload and local inference for
+//                     each sampled frame.
+//
+// Keeps an exponentially weighted average of cloud round-trip time and of
+// local inference time, plus a count of consecutive cloud failures. Frames
+// go to the cloud unless it is failing or both slower than CLOUD_SLOW_MS and
+// slower than running locally. While on local, one frame every
+// CLOUD_PROBE_MS is still sent to the cloud to notice when it recovers.
+
+#pragma once
+
+#include "DriveLens.h"
+
+class InferencePolicy {
+public:
+	explicit InferencePolicy(bool localAvailable);
+
+	// Decide for the next frame. True = run the local detector.
+	bool chooseLocal();
+
+	void recordCloud(bool ok, double elapsedMs);
+	void recordLocal(double elapsedMs);
+
+	bool   usingLocal()   const { return m_usingLocal.load(std::memory_order_relaxed); }
+	bool   cloudFailing() const;   // FALLBACK_FAILURES in a row, not just slow
+	double cloudMs()      const;
+	double localMs()      const;
+
+private:
+	bool localPreferredLocked() const;
+
+	const bool m_localAvailable;
+
+	mutable std::mutex m_mutex;
+	double   m_cloudMs     = 0.0;   // EWMA, 0 until first sample
+	double   m_localMs     = 0.0;
+	int      m_failures    = 0;     // consecutive cloud failures
+	std::chrono::steady_clock::time_point m_lastCloudAttempt{};
+
+	std::atomic<bool> m_usingLocal{ false };
+};
@@ -0,0 +1,98 @@
+// JpegEncoder.cpp : Persistent libjpeg-turbo compressor for upload frames.
+
+#include "JpegEncoder.h"
+#include "config.h"
+
+JpegEncoder::JpegEncoder()
+{
+	m_cinfo.err = jpeg_std_error(&m_error.pub);
+	m_error.pub.error_exit = onError;
+	if (setjmp(m_error.jump))
+		throw std::runtime_error(std::string("libjpeg init failed: ") + m_error.message);
+
+	jpeg_create_compress(&m_cinfo);
+
+	m_dest.pub.init_destination    = initDestination;
+	m_dest.pub.empty_output_buffer = emptyOutput;
+	m_dest.pub.term_destination    = termDestination;
+	m_cinfo.dest = &m_dest.pub;
+
+	m_rows.resize(2 * DCTSIZE);
+}
+
+JpegEncoder::~JpegEncoder()
+{
+	jpeg_destroy_compress(&m_cinfo);
+}
+
+// ── libjpeg callbacks ────────────────────────────────────────────────
+void JpegEncoder::onError(j_common_ptr cinfo)
+{
+	auto* error = reinterpret_cast<ErrorManager*>(cinfo->err);
+	(*cinfo->err->format_message)(cinfo, error->message);
+	std::longjmp(error->jump, 1);
+}
+
+// Write straight into the caller's vector, doubling it when libjpeg runs
+// out. Growing to the capacity does not touch the bytes (JpegBytes).
+void JpegEncoder::initDestination(j_compress_ptr cinfo)
+{
+	auto* dest = reinterpret_cast<Destination*>(cinfo->dest);
+	dest->out->resize(std::max<size_t>(dest->out->capacity(), ENCODE_RESERVE_BYTES));
+	dest->pub.next_output_byte = dest->out->data();
+	dest->pub.free_in_buffer   = dest->out->size();
+}
+
+boolean JpegEncoder::emptyOutput(j_compress_ptr cinfo)
+{
+	auto* dest = reinterpret_cast<Destination*>(cinfo->dest);
+	size_t used = dest->out->size();
+	dest->out->resize(used * 2);
+	dest->pub.next_output_byte = dest->out->data() + used;
+	dest->pub.free_in_buffer   = dest->out->size() - used;
+	return TRUE;
+}
+
+void JpegEncoder::termDestination(j_compress_ptr cinfo)
+{
+	auto* dest = reinterpret_cast<Destination*>(cinfo->dest);
+	dest->out->resize(dest->out->size() - dest->pub.free_in_buffer);
+}
+
+// ── encode ───────────────────────────────────────────────────────────
+bool JpegEncoder::encode(const cv::Mat& bgr, int quality, JpegBytes& out)
+{
+	if (bgr.empty() || bgr.type() != CV_8UC3) return false;
+
+	m_dest.out = &out;
+
+	if (setjmp(m_error.jump)) {
+		jpeg_abort_compress(&m_cinfo);
+		out.clear();   // not the partly written reserve
+		std::cerr << "[JPEG] Encode failed: " << m_error.message << std::endl;
+		return false;
+	}
+
+	m_cinfo.image_width      = bgr.cols;
+	m_cinfo.image_height     = bgr.rows;
+	m_cinfo.input_components = 3;
+	m_cinfo.in_color_space   = JCS_EXT_BGR;
+	jpeg_set_defaults(&m_cinfo);   // YCbCr 4:2:0, as cv::imencode
+	jpeg_set_quality(&m_cinfo, quality, TRUE);
+
+	jpeg_start_compress(&m_cinfo, TRUE);
+
+	// Hand libjpeg a whole MCU row per call so each strip is converted,
+	// downsampled and transformed together
+	while (m_cinfo.next_scanline < m_cinfo.image_height) {
+		JDIMENSION row   = m_cinfo.next_scanline;
+		JDIMENSION lines = std::min<JDIMENSION>(static_cast<JDIMENSION>(m_rows.size()),
+												m_cinfo.image_height - row);
+		for (JDIMENSION i = 0; i < lines; ++i)
+			m_rows[i] = const_cast<JSAMPROW>(bgr.ptr<uchar>(row + i));
+		jpeg_write_scanlines(&m_cinfo, m_rows.data(), lines);
+	}
+
+	jpeg_finish_compress(&m_cinfo);
+	return true;
+}
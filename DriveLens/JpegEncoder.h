@@ -0,0 +1,80 @@
+// JpegEncoder.h : JPEG encode stage of the upload path.
+//
+// cv::imencode builds a new libjpeg compressor for every image and copies
+// the bytes out of its own destination buffer. JpegEncoder keeps one
+// compressor alive and writes straight into the caller's (pooled) vector.
+// Frames go in as BGR scanlines (libjpeg-turbo JCS_EXT_BGR): colour
+// conversion and 4:2:0 chroma downsampling then run in turbo's SIMD
+// kernels one MCU row (16 lines) at a time, while the strip is in cache,
+// instead of as separate full-image passes.
+//
+// The output is a JpegBytes vector, whose resize() leaves new bytes
+// uninitialized: libjpeg overwrites them, so the reserve is not zero-filled
+// before every encode.
+//
+// libjpeg compress objects are not thread-safe: use one encoder per thread.
+
+#pragma once
+
+#include "DriveLens.h"
+
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+
+#ifndef JCS_EXTENSIONS
+#error "JpegEncoder needs libjpeg-turbo (JCS_EXT_BGR input)"
+#endif
+
+// Allocator whose value-initialization (resize) default-initializes.
+template <typename T>
+struct DefaultInitAllocator : std::allocator<T> {
+	template <typename U> struct rebind { using other = DefaultInitAllocator<U>; };
+
+	DefaultInitAllocator() = default;
+	template <typename U> DefaultInitAllocator(const DefaultInitAllocator<U>&) noexcept {}
+
+	template <typename U> void construct(U* p) { ::new (static_cast<void*>(p)) U; }
+	template <typename U, typename... Args> void construct(U* p, Args&&... args)
+	{
+		::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+	}
+};
+
+using JpegBytes = std::vector<uchar, DefaultInitAllocator<uchar>>;
+
+class JpegEncoder {
+public:
+	JpegEncoder();
+	~JpegEncoder();
+
+	JpegEncoder(const JpegEncoder&)            = delete;
+	JpegEncoder& operator=(const JpegEncoder&) = delete;
+
+	// Encode a CV_8UC3 BGR image at `quality` (1-100). `out` is resized
+	// to the JPEG bytes and keeps its capacity across calls; it is empty
+	// after a failed encode.
+	bool encode(const cv::Mat& bgr, int quality, JpegBytes& out);
+
+private:
+	struct ErrorManager {
+		jpeg_error_mgr pub;
+		std::jmp_buf   jump;
+		char           message[JMSG_LENGTH_MAX];
+	};
+
+	struct Destination {
+		jpeg_destination_mgr pub;
+		JpegBytes*           out = nullptr;
+	};
+
+	static void    onError(j_common_ptr cinfo);
+	static void    initDestination(j_compress_ptr cinfo);
+	static boolean emptyOutput(j_compress_ptr cinfo);
+	static void    termDestination(j_compress_ptr cinfo);
+
+	jpeg_compress_struct  m_cinfo;
+	ErrorManager          m_error;
+	Destination           m_dest;
+	std::vector<JSAMPROW> m_rows;   // one MCU row of scanline pointers
+};
@@ -0,0 +1,45 @@
+// LabelSprites.cpp : Pre-rendered label sprites.
+
+#include "LabelSprites.h"
+#include "CocoClasses.h"
+
+// ── sprite ───────────────────────────────────────────────────────────
+// Same geometry the overlay used when drawing directly: a filled tag
+// (text + 5) x (text + 7) with the text origin 2 px in from the left and
+// 4 px up from the bottom.
+const cv::Mat& LabelSprites::sprite(uint8_t classId)
+{
+	uint32_t key = static_cast<uint32_t>(std::lround(m_fontScale * 1000)) << 8 | classId;
+	auto it = m_sprites.find(key);
+	if (it != m_sprites.end()) return it->second;
+
+	const char* label = cocoLabel(classId);
+	int baseline = 0;
+	cv::Size text = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX,
+									m_fontScale, m_thickness, &baseline);
+
+	cv::Mat tag(text.height + 7, text.width + 5, CV_8UC3, cv::Scalar(0, 255, 0));
+	cv::putText(tag, label, cv::Point(2, text.height + 2),
+				cv::FONT_HERSHEY_SIMPLEX, m_fontScale,
+				cv::Scalar(0, 0, 0), m_thickness);
+
+	return m_sprites.emplace(key, std::move(tag)).first->second;
+}
+
+// ── draw ─────────────────────────────────────────────────────────────
+void LabelSprites::draw(cv::Mat& frame, uint8_t classId, int x, int y)
+{
+	CV_Assert(frame.type() == CV_8UC3);
+
+	const cv::Mat& tag = sprite(classId);
+	int textHeight = tag.rows - 7;
+
+	// Sit above the box, but never above the top edge
+	int labelY = std::max(y - 6, textHeight + 4);
+	cv::Rect target(x, labelY - textHeight - 4, tag.cols, tag.rows);
+
+	cv::Rect visible = target & cv::Rect(0, 0, frame.cols, frame.rows);
+	if (visible.empty()) return;
+
+	tag(visible - target.tl()).copyTo(frame(visible));
+}
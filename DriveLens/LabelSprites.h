@@ -0,0 +1,32 @@
+// LabelSprites.h : Cache of pre-rendered detection labels for the overlay.
+//
+// A label is the filled green tag with the class name in black. Rasterizing
+// it with cv::getTextSize / cv::putText (Hershey vector font) for every box
+// on every frame is wasted work: there are only a handful of classes. Each
+// (class id, font scale) pair is rendered once into a small BGR sprite and
+// afterwards drawn with a single ROI copy, clipped to the frame.
+//
+// Not thread-safe; owned by the display loop.
+
+#pragma once
+
+#include "DriveLens.h"
+
+class LabelSprites {
+public:
+	explicit LabelSprites(double fontScale = 0.5, int thickness = 1)
+		: m_fontScale(fontScale), m_thickness(thickness) {}
+
+	// Draw the label of `classId` above a box whose top-left corner is
+	// (x, y). `frame` must be CV_8UC3.
+	void draw(cv::Mat& frame, uint8_t classId, int x, int y);
+
+	size_t cached() const { return m_sprites.size(); }
+
+private:
+	const cv::Mat& sprite(uint8_t classId);
+
+	double m_fontScale;
+	int    m_thickness;
+	std::unordered_map<uint32_t, cv::Mat> m_sprites;   // key: scale << 8 | classId
+};
@@ -0,0 +1,159 @@
+// LatencyStats.cpp : Log-linear bucketing and percentile summaries.
+
+#include "LatencyStats.h"
+
+#include <bit>
+#include <sstream>
+
+const char* stageName(Stage stage)
+{
+	switch (stage) {
+	case Stage::Capture: return "capture";
+	case Stage::Resize:  return "resize";
+	case Stage::Encode:  return "encode";
+	case Stage::Upload:  return "upload";
+	case Stage::Parse:   return "parse";
+	case Stage::Local:   return "local";
+	case Stage::Draw:    return "draw";
+	default:             return "?";
+	}
+}
+
+// ── Buckets ──────────────────────────────────────────────────────────
+// Values below SUB_BUCKETS map to themselves; above, the top five
+// significant bits pick the bucket within the value's power of two.
+int LatencyStats::bucketOf(uint64_t us)
+{
+	if (us < SUB_BUCKETS) return static_cast<int>(us);
+	int exponent = std::bit_width(us) - 1;          // >= 4
+	int group    = exponent - 3;
+	int sub      = static_cast<int>((us >> (exponent - 4)) & (SUB_BUCKETS - 1));
+	return std::min(group * SUB_BUCKETS + sub, BUCKETS - 1);
+}
+
+double LatencyStats::bucketLowUs(int bucket)
+{
+	if (bucket < SUB_BUCKETS) return bucket;
+	int group = bucket / SUB_BUCKETS;
+	int sub   = bucket % SUB_BUCKETS;
+	return std::ldexp(SUB_BUCKETS + sub, group - 1);
+}
+
+// ── record ───────────────────────────────────────────────────────────
+LatencyStats::ThreadHistograms& LatencyStats::local()
+{
+	// One cache entry per thread; re-registers if a different instance
+	// is used from the same thread
+	thread_local const LatencyStats* owner     = nullptr;
+	thread_local ThreadHistograms*   histogram = nullptr;
+	if (owner != this) {
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_threads.push_back(std::make_unique<ThreadHistograms>());
+		histogram = m_threads.back().get();
+		owner     = this;
+	}
+	return *histogram;
+}
+
+void LatencyStats::record(Stage stage, int64_t elapsedNs)
+{
+	uint64_t ns = elapsedNs > 0 ? static_cast<uint64_t>(elapsedNs) : 0;
+	ThreadHistograms& h = local();
+	std::atomic<uint64_t>& count = h.counts[static_cast<int>(stage)][bucketOf(ns / 1000)];
+	std::atomic<uint64_t>& sum   = h.sumNs[static_cast<int>(stage)];
+	// Single writer: no read-modify-write needed
+	count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	sum.store(sum.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+}
+
+LatencyStats::Snapshot LatencyStats::snapshot() const
+{
+	Snapshot snap;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (const auto& thread : m_threads) {
+		for (int s = 0; s < STAGES; ++s) {
+			Histogram& h = snap.stages[s];
+			for (int b = 0; b < BUCKETS; ++b) {
+				uint64_t n = thread->counts[s][b].load(std::memory_order_relaxed);
+				h.counts[b] += n;
+				h.total     += n;
+			}
+			h.sumNs += thread->sumNs[s].load(std::memory_order_relaxed);
+		}
+	}
+	return snap;
+}
+
+// ── Histogram ────────────────────────────────────────────────────────
+// Percentiles report the middle of the bucket they fall in.
+double LatencyStats::Histogram::percentileMs(double q) const
+{
+	if (total == 0) return 0.0;
+	uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * total)));
+	uint64_t seen = 0;
+	for (int b = 0; b < BUCKETS; ++b) {
+		seen += counts[b];
+		if (seen >= rank)
+			return (bucketLowUs(b) + bucketLowUs(b + 1)) / 2 / 1000.0;
+	}
+	return maxMs();
+}
+
+// Upper edge of the highest non-empty bucket.
+double LatencyStats::Histogram::maxMs() const
+{
+	for (int b = BUCKETS - 1; b >= 0; --b)
+		if (counts[b]) return bucketLowUs(b + 1) / 1000.0;
+	return 0.0;
+}
+
+LatencyStats::Histogram& LatencyStats::Histogram::operator-=(const Histogram& earlier)
+{
+	for (int b = 0; b < BUCKETS; ++b) counts[b] -= std::min(counts[b], earlier.counts[b]);
+	total -= std::min(total, earlier.total);
+	sumNs -= std::min(sumNs, earlier.sumNs);
+	return *this;
+}
+
+LatencyStats::Snapshot LatencyStats::Snapshot::operator-(const Snapshot& earlier) const
+{
+	Snapshot diff = *this;
+	for (int s = 0; s < STAGES; ++s) diff.stages[s] -= earlier.stages[s];
+	return diff;
+}
+
+// ── Reports ──────────────────────────────────────────────────────────
+std::string LatencyStats::summary(const Snapshot& snap)
+{
+	std::ostringstream out;
+	out.precision(3);
+	for (int s = 0; s < STAGES; ++s) {
+		const Histogram& h = snap.stages[s];
+		if (h.total == 0) continue;
+		out << "  " << stageName(static_cast<Stage>(s)) << " n=" << h.total
+			<< " p50=" << h.percentileMs(0.50) << " p90=" << h.percentileMs(0.90)
+			<< " p99=" << h.percentileMs(0.99) << " max=" << h.maxMs() << "ms";
+	}
+	return out.str();
+}
+
+nlohmann::json LatencyStats::toJson(const Snapshot& snap)
+{
+	nlohmann::json stages = nlohmann::json::object();
+	for (int s = 0; s < STAGES; ++s) {
+		const Histogram& h = snap.stages[s];
+		nlohmann::json buckets = nlohmann::json::array();
+		for (int b = 0; b < BUCKETS; ++b)
+			if (h.counts[b]) buckets.push_back({ bucketLowUs(b), h.counts[b] });
+
+		stages[stageName(static_cast<Stage>(s))] = {
+			{ "count",   h.total },
+			{ "p50_ms",  h.percentileMs(0.50) },
+			{ "p90_ms",  h.percentileMs(0.90) },
+			{ "p99_ms",  h.percentileMs(0.99) },
+			{ "max_ms",  h.maxMs() },
+			{ "buckets", buckets }   // [lower bound in us, count]
+		};
+	}
+	return { { "unit", "ms" }, { "stages", stages } };
+}
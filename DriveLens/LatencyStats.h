@@ -0,0 +1,106 @@
+// LatencyStats.h : Per-stage latency histograms for the edge pipeline.
+//
+// Each pipeline stage (capture, resize, encode, upload, parse, local
+// inference, draw) records its duration into a log-linear histogram:
+// exact microsecond buckets below 16 us, then 16 sub-buckets per power of
+// two, so every bucket is within ~6% of its value from 1 us to hours.
+//
+// Every thread that records gets its own set of histograms, registered on
+// its first sample (the only time a mutex is taken). The owner is the only
+// writer of its counters, so a sample is a relaxed load and store, no
+// read-modify-write; readers sum all threads' counters with relaxed loads
+// and may see a sample or two in flight, which is fine for percentiles.
+//
+// snapshot() returns the totals since start; subtracting an earlier
+// snapshot gives the distribution over an interval.
+
+#pragma once
+
+#include "DriveLens.h"
+
+#include <deque>
+
+enum class Stage : int {
+	Capture,   // cap.read / retrieve of one frame
+	Resize,    // crop + resize into the upload buffer
+	Encode,    // JPEG encode of all upload images
+	Upload,    // HTTP round trip
+	Parse,     // response parse
+	Local,     // local inference
+	Draw,      // overlay drawing
+	Count
+};
+
+const char* stageName(Stage stage);
+
+class LatencyStats {
+public:
+	static constexpr int SUB_BUCKETS = 16;    // per power of two
+	static constexpr int BUCKETS     = 34 * SUB_BUCKETS;   // up to 2^37 us
+	static constexpr int STAGES      = static_cast<int>(Stage::Count);
+
+	struct Histogram {
+		std::array<uint64_t, BUCKETS> counts{};
+		uint64_t total = 0;
+		uint64_t sumNs = 0;   // exact, for means and Prometheus _sum
+
+		double   percentileMs(double q) const;
+		double   maxMs() const;
+		Histogram& operator-=(const Histogram& earlier);
+	};
+
+	struct Snapshot {
+		std::array<Histogram, STAGES> stages;
+
+		Snapshot operator-(const Snapshot& earlier) const;
+		const Histogram& operator[](Stage s) const { return stages[static_cast<int>(s)]; }
+	};
+
+	// Records the time from construction to destruction.
+	class Scope {
+	public:
+		Scope(LatencyStats& stats, Stage stage)
+			: m_stats(stats), m_stage(stage), m_start(std::chrono::steady_clock::now()) {}
+		~Scope()
+		{
+			m_stats.record(m_stage, std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - m_start).count());
+		}
+
+		Scope(const Scope&)            = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		LatencyStats&                         m_stats;
+		Stage                                 m_stage;
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	LatencyStats() = default;
+	LatencyStats(const LatencyStats&)            = delete;
+	LatencyStats& operator=(const LatencyStats&) = delete;
+
+	void record(Stage stage, int64_t elapsedNs);
+
+	Snapshot snapshot() const;
+
+	// One line: count and p50/p90/p99/max per stage that has samples.
+	static std::string summary(const Snapshot& snap);
+
+	// JSON with percentiles and the non-empty buckets of every stage.
+	static nlohmann::json toJson(const Snapshot& snap);
+
+	static int    bucketOf(uint64_t us);
+	static double bucketLowUs(int bucket);
+
+private:
+	struct ThreadHistograms {
+		std::array<std::array<std::atomic<uint64_t>, BUCKETS>, STAGES> counts{};
+		std::array<std::atomic<uint64_t>, STAGES>                      sumNs{};
+	};
+
+	ThreadHistograms& local();
+
+	mutable std::mutex                            m_mutex;     // registration, snapshot
+	std::deque<std::unique_ptr<ThreadHistograms>> m_threads;
+};
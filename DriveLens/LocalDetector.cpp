@@ -0,0 +1,97 @@
+// LocalDetector.cpp : YOLOv8 ONNX decoding with cv::dnn.
+
+#include "LocalDetector.h"
+#include "config.h"
+#include "CocoClasses.h"
+
+LocalDetector::LocalDetector(const std::string& modelPath)
+{
+	if (modelPath.empty()) return;
+
+	if (!std::filesystem::exists(modelPath)) {
+		std::cerr << "[Local] Model not found: " << modelPath
+				  << "  (local fallback disabled)" << std::endl;
+		return;
+	}
+
+	try {
+		m_net = cv::dnn::readNetFromONNX(modelPath);
+		m_net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+		m_net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+		m_available = !m_net.empty();
+	} catch (const cv::Exception& e) {
+		std::cerr << "[Local] Failed to load " << modelPath << ": " << e.what() << std::endl;
+	}
+
+	if (m_available)
+		std::cout << "[Local] Loaded " << modelPath << " (" << LOCAL_INPUT_SIZE
+				  << "x" << LOCAL_INPUT_SIZE << ", CPU)" << std::endl;
+}
+
+// ── detect ───────────────────────────────────────────────────────────
+// YOLOv8 emits [1, 4 + classes, anchors]: cx, cy, w, h in input pixels
+// followed by one score per class. The image is stretched (not letterboxed)
+// to the square input, so boxes scale back per axis.
+CloudResult LocalDetector::detect(const cv::Mat& image)
+{
+	CloudResult result;
+	result.imageWidth  = image.cols;
+	result.imageHeight = image.rows;
+	if (!m_available) return result;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	cv::dnn::blobFromImage(image, m_blob, 1.0 / 255.0,
+						   cv::Size(LOCAL_INPUT_SIZE, LOCAL_INPUT_SIZE),
+						   cv::Scalar(), true, false);
+	m_net.setInput(m_blob);
+	m_net.forward(m_outputs, m_net.getUnconnectedOutLayersNames());
+
+	const cv::Mat& out = m_outputs[0];
+	if (out.dims != 3) return result;
+	const int rows    = out.size[1];   // 4 + class count
+	const int anchors = out.size[2];
+	const float* data = out.ptr<float>();
+
+	const float sx = static_cast<float>(image.cols) / LOCAL_INPUT_SIZE;
+	const float sy = static_cast<float>(image.rows) / LOCAL_INPUT_SIZE;
+
+	std::vector<cv::Rect> boxes;
+	std::vector<float>    scores;
+	std::vector<int>      classIds;
+
+	for (int a = 0; a < anchors; ++a) {
+		int   best      = -1;
+		float bestScore = 0.f;
+		for (int c = 0; c < rows - 4; ++c) {
+			float score = data[(4 + c) * anchors + a];
+			if (score > bestScore) { bestScore = score; best = c; }
+		}
+		if (bestScore < LOCAL_CONF_THRESHOLD || !cocoClassName(best)) continue;
+
+		float cx = data[0 * anchors + a] * sx;
+		float cy = data[1 * anchors + a] * sy;
+		float w  = data[2 * anchors + a] * sx;
+		float h  = data[3 * anchors + a] * sy;
+		boxes.emplace_back(cvRound(cx - w / 2), cvRound(cy - h / 2), cvRound(w), cvRound(h));
+		scores.push_back(bestScore);
+		classIds.push_back(best);
+	}
+
+	std::vector<int> keep;
+	cv::dnn::NMSBoxesBatched(boxes, scores, classIds,
+							 LOCAL_CONF_THRESHOLD, LOCAL_NMS_THRESHOLD, keep);
+
+	result.objects.reserve(keep.size());
+	for (int i : keep) {
+		Detection det;
+		det.classId    = static_cast<uint8_t>(classIds[i]);
+		det.confidence = scores[i];
+		det.x_min      = boxes[i].x;
+		det.y_min      = boxes[i].y;
+		det.x_max      = boxes[i].x + boxes[i].width;
+		det.y_max      = boxes[i].y + boxes[i].height;
+		result.objects.push_back(det);
+	}
+	return result;
+}
@@ -0,0 +1,33 @@
+// LocalDetector.h : On-device YOLOv8 inference with OpenCV DNN (CPU).
+//
+// Fallback for when the cloud is unreachable or slower than running the
+// model locally. Loads an ONNX export of YOLOv8 (see README) and produces
+// the same CloudResult the server would, restricted to the same driving
+// classes and confidence threshold.
+
+#pragma once
+
+#include "DriveLens.h"
+#include "Detection.h"
+
+#include <opencv2/dnn.hpp>
+
+class LocalDetector {
+public:
+	// Loads `modelPath`; available() is false if the path is empty, the
+	// file is missing or it cannot be parsed.
+	explicit LocalDetector(const std::string& modelPath);
+
+	bool available() const { return m_available; }
+
+	// Run the model on `image` (any size). Box coordinates are in pixels of
+	// `image`. Thread-safe; concurrent callers are serialized.
+	CloudResult detect(const cv::Mat& image);
+
+private:
+	cv::dnn::Net m_net;
+	bool         m_available = false;
+	std::mutex   m_mutex;
+	cv::Mat      m_blob;
+	std::vector<cv::Mat> m_outputs;
+};
@@ -0,0 +1,191 @@
+// MetricsServer.cpp : Minimal blocking-socket HTTP listener for /metrics.
+
+#include "MetricsServer.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using SocketHandle = SOCKET;
+static void closeSocket(SocketHandle s) { closesocket(s); }
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using SocketHandle = int;
+static void closeSocket(SocketHandle s) { close(s); }
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0   // Apple sets SO_NOSIGPIPE on the socket; Windows has no SIGPIPE
+#endif
+
+// Total time a client gets to send its request headers
+static constexpr auto REQUEST_TIMEOUT = std::chrono::seconds(2);
+
+// Prometheus-style bounds; a log-linear bucket is counted under the first
+// bound at or above its upper edge.
+static constexpr double LE_SECONDS[] = { 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+										 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0 };
+
+// ── PrometheusText ───────────────────────────────────────────────────
+void PrometheusText::family(const char* name, const char* type, const char* help)
+{
+	m_out << "# HELP " << name << ' ' << help << '\n'
+		  << "# TYPE " << name << ' ' << type << '\n';
+}
+
+void PrometheusText::sample(const char* name, double value, const std::string& labels)
+{
+	m_out << name;
+	if (!labels.empty()) m_out << '{' << labels << '}';
+	m_out << ' ' << value << '\n';
+}
+
+void PrometheusText::histogram(const char* name, const LatencyStats::Histogram& h,
+							   const std::string& labels)
+{
+	std::string prefix = labels.empty() ? "" : labels + ",";
+	uint64_t cumulative = 0;
+	int      bucket     = 0;
+	for (double le : LE_SECONDS) {
+		for (; bucket < LatencyStats::BUCKETS &&
+			   LatencyStats::bucketLowUs(bucket + 1) <= le * 1e6; ++bucket)
+			cumulative += h.counts[bucket];
+		std::ostringstream bound;
+		bound << le;
+		m_out << name << "_bucket{" << prefix << "le=\"" << bound.str() << "\"} "
+			  << cumulative << '\n';
+	}
+	m_out << name << "_bucket{" << prefix << "le=\"+Inf\"} " << h.total << '\n';
+	sample((std::string(name) + "_sum").c_str(), h.sumNs / 1e9, labels);
+	sample((std::string(name) + "_count").c_str(), static_cast<double>(h.total), labels);
+}
+
+// ── MetricsServer ────────────────────────────────────────────────────
+MetricsServer::MetricsServer(int port, Render render)
+	: m_render(std::move(render))
+{
+	if (port <= 0) return;
+
+#ifdef _WIN32
+	WSADATA wsa;
+	if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+		std::cerr << "[Metrics] WSAStartup failed" << std::endl;
+		return;
+	}
+#endif
+
+	SocketHandle listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	sockaddr_in  addr{};
+	addr.sin_family      = AF_INET;
+	addr.sin_port        = htons(static_cast<uint16_t>(port));
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);   // never exposed off the device
+
+	int reuse = 1;
+	setsockopt(listener, SOL_SOCKET, SO_REUSEADDR,
+			   reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+	if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+		listen(listener, 4) != 0) {
+		std::cerr << "[Metrics] Cannot listen on 127.0.0.1:" << port << std::endl;
+		closeSocket(listener);
+#ifdef _WIN32
+		WSACleanup();
+#endif
+		return;
+	}
+
+	m_listener = static_cast<intptr_t>(listener);
+	m_thread   = std::jthread([this](std::stop_token stop) { run(stop); });
+	std::cout << "[Metrics] Serving http://127.0.0.1:" << port << "/metrics" << std::endl;
+}
+
+MetricsServer::~MetricsServer()
+{
+	if (m_thread.joinable()) {
+		m_thread.request_stop();
+		m_thread.join();
+	}
+	if (m_listener != -1) {
+		closeSocket(static_cast<SocketHandle>(m_listener));
+#ifdef _WIN32
+		WSACleanup();
+#endif
+	}
+}
+
+// ── run ──────────────────────────────────────────────────────────────
+// Waits in select() with a short timeout so a stop request is noticed.
+void MetricsServer::run(std::stop_token stop)
+{
+	SocketHandle listener = static_cast<SocketHandle>(m_listener);
+	while (!stop.stop_requested()) {
+		fd_set readable;
+		FD_ZERO(&readable);
+		FD_SET(listener, &readable);
+		timeval timeout{ 0, 200 * 1000 };
+		if (select(static_cast<int>(listener) + 1, &readable, nullptr, nullptr, &timeout) <= 0)
+			continue;
+
+		SocketHandle client = accept(listener, nullptr, nullptr);
+#ifdef _WIN32
+		if (client == INVALID_SOCKET) continue;
+#else
+		if (client < 0) continue;
+#endif
+		serve(static_cast<intptr_t>(client));
+		closeSocket(client);
+	}
+}
+
+void MetricsServer::serve(intptr_t handle)
+{
+	SocketHandle client = static_cast<SocketHandle>(handle);
+
+#ifdef SO_NOSIGPIPE
+	// A scraper hanging up mid-response must not kill the agent with SIGPIPE
+	int noSigpipe = 1;
+	setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &noSigpipe, sizeof(noSigpipe));
+#endif
+
+	// Only the request line matters; read until the end of the headers.
+	// The deadline covers the whole request so a client trickling bytes
+	// can't hold the thread either.
+	auto deadline = std::chrono::steady_clock::now() + REQUEST_TIMEOUT;
+	std::string request;
+	char chunk[1024];
+	while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+		auto left = std::chrono::duration_cast<std::chrono::microseconds>(
+			deadline - std::chrono::steady_clock::now()).count();
+		if (left <= 0) break;
+
+		fd_set readable;
+		FD_ZERO(&readable);
+		FD_SET(client, &readable);
+		timeval timeout{ static_cast<long>(left / 1000000), static_cast<long>(left % 1000000) };
+		if (select(static_cast<int>(client) + 1, &readable, nullptr, nullptr, &timeout) <= 0)
+			break;
+
+		int n = static_cast<int>(recv(client, chunk, sizeof(chunk), 0));
+		if (n <= 0) break;
+		request.append(chunk, static_cast<size_t>(n));
+	}
+
+	bool metrics = request.rfind("GET /metrics ", 0) == 0 ||
+				   request.rfind("GET /metrics?", 0) == 0;
+	std::string body = metrics ? m_render() : "not found\n";
+	std::string response =
+		std::string(metrics ? "HTTP/1.1 200 OK\r\n" : "HTTP/1.1 404 Not Found\r\n") +
+		"Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+		"Content-Length: " + std::to_string(body.size()) + "\r\n"
+		"Connection: close\r\n\r\n" + body;
+
+	size_t sent = 0;
+	while (sent < response.size()) {
+		int n = static_cast<int>(send(client, response.data() + sent,
+									  static_cast<int>(response.size() - sent), MSG_NOSIGNAL));
+		if (n <= 0) break;
+		sent += static_cast<size_t>(n);
+	}
+}
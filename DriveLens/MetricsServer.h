@@ -0,0 +1,63 @@
+// MetricsServer.h : Localhost HTTP endpoint serving pipeline metrics in the
+//                   Prometheus text exposition format.
+//
+// A single background thread listens on 127.0.0.1:METRICS_PORT and answers
+// GET /metrics with the text produced by the render callback; anything
+// else gets a 404. One scrape is served at a time, which is plenty for a
+// scraper polling every few seconds. The callback runs on the metrics
+// thread and must not contend with the capture or display loop: it reads
+// relaxed atomics only. The one lock it may take is LatencyStats'
+// registration mutex, which a recording thread only takes on its first
+// sample.
+//
+// PrometheusText builds the response body.
+
+#pragma once
+
+#include "DriveLens.h"
+#include "LatencyStats.h"
+
+#include <sstream>
+
+class PrometheusText {
+public:
+	// Enough digits that byte and frame counters print exactly.
+	PrometheusText() { m_out.precision(15); }
+
+	// Starts a metric family: "# HELP" and "# TYPE" lines.
+	void family(const char* name, const char* type, const char* help);
+
+	// One sample line; `labels` is the inside of {...}, e.g. stage="encode".
+	void sample(const char* name, double value, const std::string& labels = "");
+
+	// Cumulative le-buckets (in seconds), _sum and _count of one histogram.
+	void histogram(const char* name, const LatencyStats::Histogram& h,
+				   const std::string& labels);
+
+	std::string str() const { return m_out.str(); }
+
+private:
+	std::ostringstream m_out;
+};
+
+class MetricsServer {
+public:
+	using Render = std::function<std::string()>;
+
+	// Port 0 (or a failed bind) leaves the server stopped.
+	MetricsServer(int port, Render render);
+	~MetricsServer();
+
+	MetricsServer(const MetricsServer&)            = delete;
+	MetricsServer& operator=(const MetricsServer&) = delete;
+
+	bool running() const { return m_thread.joinable(); }
+
+private:
+	void run(std::stop_token stop);
+	void serve(intptr_t client);
+
+	Render       m_render;
+	intptr_t     m_listener = -1;   // native socket handle
+	std::jthread m_thread;
+};
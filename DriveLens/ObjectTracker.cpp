@@ -0,0 +1,144 @@
+// ObjectTracker.cpp : Sparse optical-flow box tracking between cloud results.
+
+#include "ObjectTracker.h"
+
+static float median(std::vector<float>& values)
+{
+	auto mid = values.begin() + values.size() / 2;
+	std::nth_element(values.begin(), mid, values.end());
+	return *mid;
+}
+
+ObjectTracker::ObjectTracker()
+	: m_history(TRACK_HISTORY)
+{
+	m_prevGray.create(TRACK_HEIGHT, TRACK_WIDTH, CV_8UC1);
+	m_gray.create(TRACK_HEIGHT, TRACK_WIDTH, CV_8UC1);
+}
+
+void ObjectTracker::toGray(const cv::Mat& frame, cv::Mat& gray)
+{
+	cv::resize(frame, m_scaled, cv::Size(TRACK_WIDTH, TRACK_HEIGHT), 0, 0, cv::INTER_LINEAR);
+	cv::cvtColor(m_scaled, gray, cv::COLOR_BGR2GRAY);
+}
+
+// ── seedPoints ───────────────────────────────────────────────────────
+// Pick fresh corners inside the track's box on m_prevGray and append them.
+void ObjectTracker::seedPoints(Track& track)
+{
+	track.firstPoint = m_prevPoints.size();
+	track.pointCount = 0;
+
+	cv::Rect roi = cv::Rect(track.box) & cv::Rect(0, 0, TRACK_WIDTH, TRACK_HEIGHT);
+	if (roi.width < 4 || roi.height < 4) return;
+
+	cv::goodFeaturesToTrack(m_prevGray(roi), m_seeds, TRACK_POINTS_PER_BOX, 0.01, 3.0);
+	for (const auto& p : m_seeds)
+		m_prevPoints.emplace_back(p.x + roi.x, p.y + roi.y);
+	track.pointCount = m_seeds.size();
+}
+
+void ObjectTracker::remember(uint64_t captureIndex, const cv::Mat& frame)
+{
+	Snapshot& snap = m_history[captureIndex % m_history.size()];
+	snap.captureIndex = static_cast<int64_t>(captureIndex);
+	toGray(frame, snap.gray);
+}
+
+void ObjectTracker::reseed(const CloudResult& result, uint64_t captureIndex,
+						   const cv::Mat& frame)
+{
+	m_result = result;
+	m_tracks.clear();
+	m_prevPoints.clear();
+	if (result.objects.empty()) return;
+
+	m_toTrackX = static_cast<float>(TRACK_WIDTH)  / result.imageWidth;
+	m_toTrackY = static_cast<float>(TRACK_HEIGHT) / result.imageHeight;
+
+	// Seed on the frame the server actually saw, if we still have it
+	Snapshot& snap = m_history[captureIndex % m_history.size()];
+	bool fromCapture = snap.captureIndex == static_cast<int64_t>(captureIndex);
+	if (fromCapture) {
+		std::swap(m_prevGray, snap.gray);
+		snap.captureIndex = -1;
+	} else {
+		toGray(frame, m_prevGray);
+	}
+
+	for (const auto& det : result.objects) {
+		Track track;
+		track.box = cv::Rect2f(det.x_min * m_toTrackX, det.y_min * m_toTrackY,
+							   (det.x_max - det.x_min) * m_toTrackX,
+							   (det.y_max - det.y_min) * m_toTrackY);
+		seedPoints(track);
+		m_tracks.push_back(track);
+	}
+
+	// Forward-project from the capture to the current frame
+	if (fromCapture) update(frame);
+}
+
+const CloudResult& ObjectTracker::update(const cv::Mat& frame)
+{
+	if (m_tracks.empty()) return m_result;
+
+	toGray(frame, m_gray);
+
+	if (!m_prevPoints.empty()) {
+		cv::calcOpticalFlowPyrLK(m_prevGray, m_gray, m_prevPoints, m_nextPoints,
+								 m_status, m_error,
+								 cv::Size(TRACK_WINDOW, TRACK_WINDOW), TRACK_PYR_LEVELS);
+	}
+
+	// Move each box by the median motion of its surviving points, and keep
+	// those points (in track order) as the next frame's starting points.
+	const cv::Rect2f bounds(0.f, 0.f, TRACK_WIDTH, TRACK_HEIGHT);
+	m_compact.clear();
+
+	for (auto& track : m_tracks) {
+		m_dx.clear();
+		m_dy.clear();
+		size_t first = m_compact.size();
+
+		for (size_t i = track.firstPoint; i < track.firstPoint + track.pointCount; ++i) {
+			const cv::Point2f& next = m_nextPoints[i];
+			if (!m_status[i] || !bounds.contains(next)) continue;
+			m_dx.push_back(next.x - m_prevPoints[i].x);
+			m_dy.push_back(next.y - m_prevPoints[i].y);
+			m_compact.push_back(next);
+		}
+
+		track.firstPoint = first;
+		track.pointCount = m_compact.size() - first;
+
+		if (track.pointCount >= TRACK_MIN_POINTS) {
+			track.box.x += median(m_dx);
+			track.box.y += median(m_dy);
+		}
+	}
+
+	std::swap(m_prevPoints, m_compact);
+	std::swap(m_prevGray, m_gray);
+
+	// Boxes that lost most of their points pick new ones on this frame
+	for (auto& track : m_tracks)
+		if (track.pointCount < TRACK_MIN_POINTS) seedPoints(track);
+
+	publish();
+	return m_result;
+}
+
+// ── publish ──────────────────────────────────────────────────────────
+// Copy tracker boxes back into m_result in the server's pixel space.
+void ObjectTracker::publish()
+{
+	for (size_t i = 0; i < m_tracks.size(); ++i) {
+		const cv::Rect2f& box = m_tracks[i].box;
+		Detection& det = m_result.objects[i];
+		det.x_min = cvRound(box.x / m_toTrackX);
+		det.y_min = cvRound(box.y / m_toTrackY);
+		det.x_max = cvRound((box.x + box.width)  / m_toTrackX);
+		det.y_max = cvRound((box.y + box.height) / m_toTrackY);
+	}
+}
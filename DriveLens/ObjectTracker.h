@@ -0,0 +1,66 @@
+// ObjectTracker.h : Moves the last cloud detections along with the scene
+//                   between cloud results.
+//
+// When a CloudResult arrives, a few corner features are picked inside each
+// box on a downscaled grayscale copy of the frame. Every displayed frame
+// those points are followed with pyramidal Lucas–Kanade optical flow, and
+// each box is shifted by the median motion of its points. Working at
+// TRACK_WIDTH x TRACK_HEIGHT with a dozen points per box keeps the update
+// within a few milliseconds on CPU.
+//
+// Cloud results describe the frame that was uploaded, which by the time the
+// response arrives is several hundred milliseconds old. The tracker keeps a
+// grayscale snapshot of each uploaded frame; on reseed the boxes are seeded
+// on that snapshot and carried to the current frame in a single flow step.
+
+#pragma once
+
+#include "DriveLens.h"
+#include "Detection.h"
+
+class ObjectTracker {
+public:
+	ObjectTracker();
+
+	// Keep a snapshot of the frame uploaded as `captureIndex`.
+	void remember(uint64_t captureIndex, const cv::Mat& frame);
+
+	// Start tracking `result`, computed from capture `captureIndex`, and
+	// project its boxes onto `frame`. Without a snapshot of that capture the
+	// boxes are taken to describe `frame` as-is.
+	void reseed(const CloudResult& result, uint64_t captureIndex,
+				const cv::Mat& frame);
+
+	// Advance every box to `frame`. Returns the boxes to draw.
+	const CloudResult& update(const cv::Mat& frame);
+
+	const CloudResult& current() const { return m_result; }
+
+private:
+	struct Snapshot {
+		int64_t captureIndex = -1;
+		cv::Mat gray;
+	};
+
+	struct Track {
+		cv::Rect2f box;           // in tracker (downscaled) pixels
+		size_t     firstPoint;    // range into m_prevPoints
+		size_t     pointCount;
+	};
+
+	void toGray(const cv::Mat& frame, cv::Mat& gray);
+	void seedPoints(Track& track);
+	void publish();
+
+	float m_toTrackX = 1.f, m_toTrackY = 1.f;   // result px -> tracker px
+
+	CloudResult              m_result;        // tracked boxes, result px
+	std::vector<Track>       m_tracks;
+	std::vector<Snapshot>    m_history;       // slot = captureIndex % size
+	cv::Mat                  m_scaled;        // scratch
+	cv::Mat                  m_prevGray, m_gray;
+	std::vector<cv::Point2f> m_prevPoints, m_nextPoints, m_compact, m_seeds;
+	std::vector<uchar>       m_status;
+	std::vector<float>       m_error;
+	std::vector<float>       m_dx, m_dy;
+};
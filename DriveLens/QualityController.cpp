@@ -0,0 +1,77 @@
+// QualityController.cpp : Link-driven JPEG quality / resolution ladder.
+
+#include "QualityController.h"
+#include "config.h"
+#include "Ewma.h"
+
+// Even dimensions keep the encoder's 4:2:0 chroma blocks whole
+static cv::Size scaledSize(double scale)
+{
+	return cv::Size(static_cast<int>(RESIZE_WIDTH  * scale / 2) * 2,
+					static_cast<int>(RESIZE_HEIGHT * scale / 2) * 2);
+}
+
+QualityController::QualityController()
+{
+	// Full size walks quality down from JPEG_QUALITY; each smaller size
+	// starts half-way, where its bytes roughly meet the previous rung's
+	const double scales[] = { 1.0, 0.75, 0.5, 0.375, 0.25 };
+	const int    middle   = (JPEG_QUALITY + JPEG_QUALITY_MIN) / 2;
+
+	for (double scale : scales) {
+		if (scale < ADAPT_MIN_SCALE) break;
+		int top = m_ladder.empty() ? JPEG_QUALITY : middle;
+		for (int q = top; q >= JPEG_QUALITY_MIN; q -= ADAPT_QUALITY_STEP)
+			m_ladder.push_back({ static_cast<int>(m_ladder.size()), scaledSize(scale), q });
+	}
+	if (!ADAPTIVE_QUALITY) m_ladder.resize(1);   // fixed RESIZE_* at JPEG_QUALITY
+}
+
+QualityController::Settings QualityController::current() const
+{
+	return m_ladder[m_rung.load(std::memory_order_relaxed)];
+}
+
+void QualityController::record(int rung, bool ok, size_t bytes, double elapsedMs)
+{
+	if (!ADAPTIVE_QUALITY || elapsedMs <= 0.0) return;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (ok) m_kbps = ewma(m_kbps, bytes / elapsedMs * 1000.0 / 1024.0, QUALITY_EWMA_ALPHA);
+
+	// A fast failure is the server being down, which the inference policy
+	// handles; only a slow one (timeout) says the link cannot keep up
+	if (!ok && elapsedMs < UPLOAD_TARGET_MS) return;
+	if (rung != m_rung.load(std::memory_order_relaxed)) return;
+
+	m_rttMs = ewma(m_rttMs, elapsedMs, QUALITY_EWMA_ALPHA);
+	if (++m_samples < ADAPT_SAMPLES) return;
+
+	int next = rung;
+	if (m_rttMs > UPLOAD_TARGET_MS * 1.25 && rung + 1 < static_cast<int>(m_ladder.size()))
+		next = rung + 1;
+	else if (m_rttMs < UPLOAD_TARGET_MS * 0.6 && rung > 0)
+		next = rung - 1;
+	if (next == rung) return;
+
+	const Settings& to = m_ladder[next];
+	std::cout << "[Quality] " << (next > rung ? "Lowering" : "Raising") << " upload to "
+			  << to.size.width << "x" << to.size.height << " q" << to.quality
+			  << "  (rtt " << m_rttMs << " ms, " << m_kbps << " KB/s)" << std::endl;
+
+	m_rung.store(next, std::memory_order_relaxed);
+	m_rttMs   = 0.0;
+	m_samples = 0;
+}
+
+double QualityController::rttMs() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_rttMs;
+}
+
+double QualityController::throughputKBps() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_kbps;
+}
@@ -0,0 +1,49 @@
+// QualityController.h : Adapts upload JPEG quality and resolution to the
+//                       measured link.
+//
+// Settings come from a ladder of rungs, ordered from largest to smallest
+// upload: full RESIZE_WIDTH x RESIZE_HEIGHT at JPEG_QUALITY first, then
+// lower quality, then smaller sizes down to ADAPT_MIN_SCALE and
+// JPEG_QUALITY_MIN. Every finished upload reports its size and round-trip
+// time; once ADAPT_SAMPLES uploads made at the current rung have come back,
+// the EWMA round trip is compared with UPLOAD_TARGET_MS and the controller
+// steps one rung down (slower than target + 25%) or up (faster than 60% of
+// target). Results from uploads still in flight at an older rung are not
+// used for the decision, so one slow burst does not cascade.
+//
+// current() is read by the pipeline thread, record() is called by the
+// upload workers.
+
+#pragma once
+
+#include "DriveLens.h"
+
+class QualityController {
+public:
+	struct Settings {
+		int      rung    = 0;
+		cv::Size size;
+		int      quality = 0;
+	};
+
+	QualityController();
+
+	// Settings for the next capture; pass `rung` back to record().
+	Settings current() const;
+
+	// One finished upload: JPEG size, round trip and whether it succeeded.
+	void record(int rung, bool ok, size_t bytes, double elapsedMs);
+
+	size_t rungs()          const { return m_ladder.size(); }
+	double rttMs()          const;
+	double throughputKBps() const;
+
+private:
+	std::vector<Settings> m_ladder;
+	std::atomic<int>      m_rung{ 0 };
+
+	mutable std::mutex m_mutex;
+	double m_rttMs   = 0.0;   // EWMA at the current rung, 0 until sampled
+	double m_kbps    = 0.0;   // EWMA upload throughput (KB/s), all rungs
+	int    m_samples = 0;     // uploads seen at the current rung
+};
@@ -0,0 +1,87 @@
+// SpoolDrainer.cpp : Rate-limited replay thread for spooled uploads.
+
+#include "SpoolDrainer.h"
+#include "config.h"
+
+SpoolDrainer::SpoolDrainer(UploadSpool& spool, UploadClient& uploader)
+	: m_spool(spool), m_uploader(uploader)
+{
+	if (m_spool.available())
+		m_thread = std::jthread([this](std::stop_token stop) { run(stop); });
+}
+
+SpoolDrainer::~SpoolDrainer()
+{
+	if (m_thread.joinable()) {
+		m_thread.request_stop();
+		m_thread.join();
+	}
+}
+
+// Returns false when a stop was requested during the sleep.
+bool SpoolDrainer::sleepFor(std::stop_token& stop, std::chrono::milliseconds duration)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	return !m_wake.wait_for(lock, stop, duration, [] { return false; })
+		&& !stop.stop_requested();
+}
+
+// ── run ──────────────────────────────────────────────────────────────
+void SpoolDrainer::run(std::stop_token stop)
+{
+	const auto interval = std::chrono::milliseconds(
+		static_cast<int>(1000.0 / SPOOL_REPLAY_PER_SEC));
+	int backoffMs = SPOOL_RETRY_MIN_MS;
+	int attempts  = 0;   // server errors for the head record
+	SpoolRecord head;    // record `attempts` counts for
+
+	SpoolRecord        record;
+	std::vector<uchar> jpeg;
+	jpeg.reserve(ENCODE_RESERVE_BYTES);
+
+	while (!stop.stop_requested()) {
+		if (!m_spool.peek(record, jpeg)) {
+			if (!sleepFor(stop, std::chrono::milliseconds(SPOOL_IDLE_MS))) break;
+			continue;
+		}
+
+		if (record.wallMs != head.wallMs || record.captureIndex != head.captureIndex) {
+			head     = record;   // new head (replayed, dropped or trimmed)
+			attempts = 0;
+		}
+
+		// Wall-clock name: capture indices restart with the process
+		std::string filename = "spool_" + std::to_string(record.wallMs) + "_"
+							 + std::to_string(record.captureIndex) + ".jpg";
+		long status = 0;
+		std::string response = m_uploader.upload(jpeg, filename, {
+			{ "frame_index", std::to_string(record.frameIndex) },
+			{ "capture_ns",  std::to_string(record.captureNs) }
+		}, &status);
+
+		if (response.empty()) {
+			m_failures.fetch_add(1, std::memory_order_relaxed);
+
+			// The server answered and refused this frame: a 4xx will not
+			// change on retry; 5xx (and timeout / rate-limit 4xx) may, a few times
+			bool busy    = status == 408 || status == 429;
+			bool refused = (status >= 400 && status < 500 && !busy)
+						|| ((status >= 500 || busy) && ++attempts >= SPOOL_MAX_ATTEMPTS);
+			if (refused) {
+				std::cerr << "[Spool] Dropping " << filename << " (HTTP " << status << ")"
+						  << std::endl;
+				m_spool.commit(false);
+				if (!sleepFor(stop, interval)) break;
+				continue;
+			}
+
+			if (!sleepFor(stop, std::chrono::milliseconds(backoffMs))) break;
+			backoffMs = std::min(backoffMs * 2, SPOOL_RETRY_MAX_MS);
+			continue;
+		}
+
+		m_spool.commit();
+		backoffMs = SPOOL_RETRY_MIN_MS;
+		if (!sleepFor(stop, interval)) break;
+	}
+}
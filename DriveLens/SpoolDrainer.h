@@ -0,0 +1,43 @@
+// SpoolDrainer.h : Background replay of the upload spool.
+//
+// One thread takes the oldest spooled frame and posts it again through the
+// shared UploadClient, at most SPOOL_REPLAY_PER_SEC frames per second so
+// the backlog never crowds out live uploads. A failed replay leaves the
+// record in place and backs off exponentially from SPOOL_RETRY_MIN_MS to
+// SPOOL_RETRY_MAX_MS, which is how the drainer notices the server is back
+// without any signal from the live pipeline. Only transport failures are
+// retried indefinitely: a record the server refuses with a 4xx is dropped
+// at once, and one answered with 5xx (or 408 / 429) SPOOL_MAX_ATTEMPTS
+// times is dropped too, so a frame the server can never take does not block the
+// backlog (UploadSpool::rejected()). Replay results are only stored by the
+// server; they are not shown.
+
+#pragma once
+
+#include "DriveLens.h"
+#include "UploadClient.h"
+#include "UploadSpool.h"
+
+class SpoolDrainer {
+public:
+	// Starts the thread only when the spool is available.
+	SpoolDrainer(UploadSpool& spool, UploadClient& uploader);
+	~SpoolDrainer();
+
+	SpoolDrainer(const SpoolDrainer&)            = delete;
+	SpoolDrainer& operator=(const SpoolDrainer&) = delete;
+
+	uint64_t failures() const { return m_failures.load(std::memory_order_relaxed); }
+
+private:
+	void run(std::stop_token stop);
+	bool sleepFor(std::stop_token& stop, std::chrono::milliseconds duration);
+
+	UploadSpool&  m_spool;
+	UploadClient& m_uploader;
+
+	std::mutex                  m_mutex;    // only for the interruptible sleep
+	std::condition_variable_any m_wake;
+	std::atomic<uint64_t>       m_failures{ 0 };
+	std::jthread                m_thread;   // last: joined before the rest is destroyed
+};
@@ -0,0 +1,223 @@
+// UploadClient.cpp : Pooled keep-alive sessions for frame uploads.
+
+#include "UploadClient.h"
+#include "config.h"
+#include "CloudResponse.h"
+
+#include <curl/curl.h>
+#include <cstring>
+#include <deque>
+#include <random>
+
+// ── MultipartStream ──────────────────────────────────────────────────
+// Serves the request body to curl's read callback as a list of segments:
+// small owned strings (part headers, boundaries) and the callers' JPEG
+// buffers, which are read in place.
+struct UploadClient::MultipartStream {
+	std::deque<std::string>            owned;      // stable addresses
+	std::vector<std::span<const char>> segments;
+	size_t                             segment = 0;
+	size_t                             offset  = 0;
+
+	void text(std::string s)
+	{
+		owned.push_back(std::move(s));
+		segments.emplace_back(owned.back().data(), owned.back().size());
+	}
+
+	void bytes(std::span<const uchar> data)
+	{
+		segments.emplace_back(reinterpret_cast<const char*>(data.data()), data.size());
+	}
+
+	size_t size() const
+	{
+		size_t total = 0;
+		for (const auto& seg : segments) total += seg.size();
+		return total;
+	}
+
+	size_t read(char* out, size_t capacity)
+	{
+		size_t written = 0;
+		while (written < capacity && segment < segments.size()) {
+			std::span<const char> seg = segments[segment];
+			size_t n = std::min(seg.size() - offset, capacity - written);
+			std::memcpy(out + written, seg.data() + offset, n);
+			written += n;
+			offset  += n;
+			if (offset == seg.size()) { ++segment; offset = 0; }
+		}
+		return written;
+	}
+
+	// Position the stream `position` bytes into the body. False past the end.
+	bool seek(size_t position)
+	{
+		segment = 0;
+		offset  = 0;
+		while (segment < segments.size() && position >= segments[segment].size()) {
+			position -= segments[segment].size();
+			++segment;
+		}
+		offset = position;
+		return segment < segments.size() || position == 0;
+	}
+
+	// CURLOPT_SEEKFUNCTION: libcurl rewinds the body when it has to resend
+	// the POST, e.g. after a kept-alive connection turned out to be closed
+	// by the server.
+	static int seekCallback(void* userp, curl_off_t position, int origin)
+	{
+		auto* stream = static_cast<MultipartStream*>(userp);
+		if (origin != SEEK_SET || position < 0 || !stream->seek(static_cast<size_t>(position)))
+			return CURL_SEEKFUNC_CANTSEEK;
+		return CURL_SEEKFUNC_OK;
+	}
+};
+
+namespace {
+
+std::string makeBoundary()
+{
+	static constexpr char hex[] = "0123456789abcdef";
+	std::random_device rd;
+	std::string boundary = "----DriveLens";
+	for (int i = 0; i < 24; ++i) boundary += hex[rd() % 16];
+	return boundary;
+}
+
+} // namespace
+
+UploadClient::UploadClient(std::string url, size_t poolSize, int timeoutMs)
+	: m_url(std::move(url)), m_boundary(makeBoundary())
+{
+	if (poolSize == 0) poolSize = 1;
+
+	for (size_t i = 0; i < poolSize; ++i) {
+		auto session = std::make_unique<cpr::Session>();
+		session->SetUrl(cpr::Url{ m_url });
+		session->SetTimeout(cpr::Timeout{ timeoutMs });
+		session->SetConnectTimeout(cpr::ConnectTimeout{ UPLOAD_CONNECT_MS });
+		session->SetHeader(cpr::Header{
+			{ "Connection",   "keep-alive" },
+			{ "Content-Type", "multipart/form-data; boundary=" + m_boundary },
+			{ "Accept",       BINARY_RESPONSE
+								  ? std::string(BINARY_CONTENT_TYPE) + ", application/json;q=0.5"
+								  : std::string("application/json") }
+		});
+
+		// TCP keep-alive probes stop NAT boxes on cellular links from
+		// silently dropping the idle connection between captures.
+		CURL* handle = session->GetCurlHolder()->handle;
+		curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+		curl_easy_setopt(handle, CURLOPT_TCP_KEEPIDLE,  static_cast<long>(UPLOAD_KEEPALIVE_SEC));
+		curl_easy_setopt(handle, CURLOPT_TCP_KEEPINTVL, static_cast<long>(UPLOAD_KEEPALIVE_SEC));
+
+		m_idle.push_back(session.get());
+		m_sessions.push_back(std::move(session));
+	}
+}
+
+cpr::Session* UploadClient::acquire()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_available.wait(lock, [this] { return !m_idle.empty(); });
+	cpr::Session* session = m_idle.back();
+	m_idle.pop_back();
+	return session;
+}
+
+void UploadClient::release(cpr::Session* session)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_idle.push_back(session);
+	}
+	m_available.notify_one();
+}
+
+// ── Multipart body ───────────────────────────────────────────────────
+void UploadClient::appendFields(MultipartStream& stream, const FormFields& fields) const
+{
+	for (const auto& [name, value] : fields) {
+		stream.text("--" + m_boundary + "\r\n"
+					"Content-Disposition: form-data; name=\"" + name + "\"\r\n\r\n"
+					+ value + "\r\n");
+	}
+}
+
+void UploadClient::appendFile(MultipartStream& stream, const char* field,
+							  const UploadFile& file) const
+{
+	stream.text("--" + m_boundary + "\r\n"
+				"Content-Disposition: form-data; name=\"" + field + "\"; filename=\""
+				+ file.filename + "\"\r\n"
+				"Content-Type: image/jpeg\r\n\r\n");
+	stream.bytes(file.jpeg);
+	stream.text("\r\n");
+}
+
+// ── upload ───────────────────────────────────────────────────────────
+std::string UploadClient::upload(std::span<const uchar> jpeg,
+								 const std::string& filename,
+								 const FormFields& fields,
+								 long* status)
+{
+	MultipartStream stream;
+	appendFields(stream, fields);
+	appendFile(stream, "file", UploadFile{ jpeg, filename });
+	stream.text("--" + m_boundary + "--\r\n");
+	return send(stream, filename, jpeg.size(), status);
+}
+
+// ── uploadTiles ──────────────────────────────────────────────────────
+std::string UploadClient::uploadTiles(std::span<const UploadFile> files,
+									  const FormFields& fields)
+{
+	if (files.empty()) return "";
+
+	MultipartStream stream;
+	size_t bytes = 0;
+	appendFields(stream, fields);
+	for (const UploadFile& file : files) {
+		appendFile(stream, "files", file);
+		bytes += file.jpeg.size();
+	}
+	stream.text("--" + m_boundary + "--\r\n");
+	return send(stream, files[0].filename + " +" + std::to_string(files.size() - 1) + " tiles",
+				bytes, nullptr);
+}
+
+// ── send ─────────────────────────────────────────────────────────────
+std::string UploadClient::send(MultipartStream& stream, const std::string& label,
+							   size_t bytes, long* status)
+{
+	cpr::Session* session = acquire();
+	session->SetReadCallback(cpr::ReadCallback{
+		static_cast<cpr::cpr_off_t>(stream.size()),
+		[&stream](char* buffer, size_t& size, intptr_t) {
+			size = stream.read(buffer, size);
+			return true;
+		}
+	});
+	CURL* handle = session->GetCurlHolder()->handle;
+	curl_easy_setopt(handle, CURLOPT_SEEKFUNCTION, &MultipartStream::seekCallback);
+	curl_easy_setopt(handle, CURLOPT_SEEKDATA,     &stream);
+	cpr::Response res = session->Post();
+	curl_easy_setopt(handle, CURLOPT_SEEKDATA,     nullptr);
+	release(session);
+	if (status) *status = res.status_code;
+
+	if (res.status_code == 200) {
+		std::cout << "[Upload] " << label
+				  << "  OK (" << bytes << " bytes, "
+				  << static_cast<int>(res.elapsed * 1000) << " ms)" << std::endl;
+		return res.text;
+	}
+
+	std::cerr << "[Upload] " << label
+			  << "  FAILED  status=" << res.status_code
+			  << "  error=" << res.error.message << std::endl;
+	return "";
+}
@@ -0,0 +1,65 @@
+// UploadClient.h : Reusable HTTP upload client for the cloud endpoint.
+//
+// Holds a small pool of long-lived cpr::Session objects. Each session owns
+// one libcurl easy handle, and libcurl keeps the connection to the server
+// open between requests on the same handle, so after the first upload a
+// frame only pays request latency – no TCP (or TLS) handshake per capture.
+//
+// The multipart/form-data body is streamed to curl through a read callback
+// directly from the caller's encoded buffers, so a JPEG is never copied
+// into an intermediate string or curl_mime part. A seek callback lets curl
+// rewind it when a request has to be resent on a fresh connection.
+
+#pragma once
+
+#include "DriveLens.h"
+
+// Extra text fields sent ahead of the file part, e.g. capture metadata.
+using FormFields = std::vector<std::pair<std::string, std::string>>;
+
+// One JPEG of a multi-file upload.
+struct UploadFile {
+	std::span<const uchar> jpeg;
+	std::string            filename;
+};
+
+class UploadClient {
+public:
+	UploadClient(std::string url, size_t poolSize, int timeoutMs);
+
+	UploadClient(const UploadClient&)            = delete;
+	UploadClient& operator=(const UploadClient&) = delete;
+
+	// POST one JPEG as multipart field "file", plus any text `fields`.
+	// Blocks while every session is busy; `jpeg` must stay alive until the
+	// call returns. Returns the response body on HTTP 200, or "" on failure.
+	// `status`, if given, receives the HTTP status (0: no response).
+	std::string upload(std::span<const uchar> jpeg,
+					   const std::string& filename,
+					   const FormFields& fields = {},
+					   long* status = nullptr);
+
+	// POST several JPEGs (tiles of one frame) in a single request, as
+	// repeated multipart field "files". Same contract as upload().
+	std::string uploadTiles(std::span<const UploadFile> files,
+							const FormFields& fields = {});
+
+private:
+	struct MultipartStream;
+
+	void          appendFields(MultipartStream& stream, const FormFields& fields) const;
+	void          appendFile(MultipartStream& stream, const char* field,
+							 const UploadFile& file) const;
+	std::string   send(MultipartStream& stream, const std::string& label, size_t bytes,
+					   long* status);
+
+	cpr::Session* acquire();
+	void          release(cpr::Session* session);
+
+	std::string                                m_url;
+	std::string                                m_boundary;
+	std::vector<std::unique_ptr<cpr::Session>> m_sessions;
+	std::vector<cpr::Session*>                 m_idle;
+	std::mutex                                 m_mutex;
+	std::condition_variable                    m_available;
+};
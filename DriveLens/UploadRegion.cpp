@@ -0,0 +1,124 @@
+// UploadRegion.cpp : Road-band crops and tiles, and the mapping back to
+//                    the frame.
+
+#include "UploadRegion.h"
+#include "config.h"
+
+// ── roiBand ──────────────────────────────────────────────────────────
+static cv::Rect roiBand(cv::Size frame)
+{
+	cv::Rect full(0, 0, frame.width, frame.height);
+	if (!ROI_UPLOADS) return full;
+
+	// Even origin and size keep 4:2:0 chroma aligned with the source
+	int x0 = static_cast<int>(frame.width  * ROI_LEFT)   & ~1;
+	int x1 = static_cast<int>(frame.width  * ROI_RIGHT)  & ~1;
+	int y0 = static_cast<int>(frame.height * ROI_TOP)    & ~1;
+	int y1 = static_cast<int>(frame.height * ROI_BOTTOM) & ~1;
+	return cv::Rect(x0, y0, x1 - x0, y1 - y0) & full;
+}
+
+// ── uploadRegion ─────────────────────────────────────────────────────
+cv::Rect uploadRegion(cv::Size frame, uint64_t captureIndex)
+{
+	if (TILED_UPLOADS || captureIndex % ROI_FULL_EVERY == 0)
+		return cv::Rect(0, 0, frame.width, frame.height);
+	return roiBand(frame);
+}
+
+// ── tileRegion ───────────────────────────────────────────────────────
+// Equal cells over the band, each grown by half of TILE_OVERLAP towards
+// its inner neighbours.
+cv::Rect tileRegion(cv::Size frame, int index)
+{
+	cv::Rect band = roiBand(frame);
+	int col = index % TILE_COLS;
+	int row = index / TILE_COLS;
+	int half = TILE_OVERLAP / 2;
+
+	int x0 = band.x + band.width  * col       / TILE_COLS - (col > 0 ? half : 0);
+	int x1 = band.x + band.width  * (col + 1) / TILE_COLS + (col < TILE_COLS - 1 ? half : 0);
+	int y0 = band.y + band.height * row       / TILE_ROWS - (row > 0 ? half : 0);
+	int y1 = band.y + band.height * (row + 1) / TILE_ROWS + (row < TILE_ROWS - 1 ? half : 0);
+	x0 &= ~1; x1 &= ~1; y0 &= ~1; y1 &= ~1;
+	return cv::Rect(x0, y0, x1 - x0, y1 - y0) & band;
+}
+
+// ── uploadSize ───────────────────────────────────────────────────────
+// The full view follows the rung's size directly. A crop keeps native
+// resolution up to `maxWidth`, scaled by the same factor the rung applies
+// to the full view.
+cv::Size uploadSize(cv::Size frame, const cv::Rect& region,
+					const QualityController::Settings& sizing, int maxWidth)
+{
+	if (region.size() == frame) return sizing.size;
+
+	double rungScale = static_cast<double>(sizing.size.width) / RESIZE_WIDTH;
+	double scale     = std::min(1.0, maxWidth * rungScale / region.width);
+	return cv::Size(std::max(2, static_cast<int>(region.width  * scale / 2) * 2),
+					std::max(2, static_cast<int>(region.height * scale / 2) * 2));
+}
+
+// ── mapToFrame ───────────────────────────────────────────────────────
+void mapToFrame(CloudResult& result, const cv::Rect& region, cv::Size frame)
+{
+	if (result.imageWidth <= 0 || result.imageHeight <= 0) return;
+
+	double sx = static_cast<double>(region.width)  / result.imageWidth;
+	double sy = static_cast<double>(region.height) / result.imageHeight;
+	for (Detection& det : result.objects) {
+		det.x_min = region.x + cvRound(det.x_min * sx);
+		det.y_min = region.y + cvRound(det.y_min * sy);
+		det.x_max = region.x + cvRound(det.x_max * sx);
+		det.y_max = region.y + cvRound(det.y_max * sy);
+	}
+	result.imageWidth  = frame.width;
+	result.imageHeight = frame.height;
+}
+
+// ── keepOutside ──────────────────────────────────────────────────────
+void keepOutside(CloudResult& result, const CloudResult& previous, const cv::Rect& region)
+{
+	if (previous.imageWidth  != result.imageWidth ||
+		previous.imageHeight != result.imageHeight) return;
+
+	for (const Detection& det : previous.objects) {
+		cv::Point centre((det.x_min + det.x_max) / 2, (det.y_min + det.y_max) / 2);
+		if (!region.contains(centre)) result.objects.push_back(det);
+	}
+}
+
+// ── mergeTiles ───────────────────────────────────────────────────────
+// Class-aware NMS over the union: an object cut by a tile edge, or seen
+// in both the full view and a tile, keeps only its best-scoring box.
+CloudResult mergeTiles(std::vector<CloudResult>& results)
+{
+	if (results.empty()) return {};
+	if (results.size() == 1) return std::move(results[0]);
+
+	std::vector<cv::Rect> boxes;
+	std::vector<float>    scores;
+	std::vector<int>      classIds;
+	std::vector<const Detection*> dets;
+	for (const CloudResult& tile : results) {
+		for (const Detection& det : tile.objects) {
+			boxes.emplace_back(det.x_min, det.y_min,
+							   det.x_max - det.x_min, det.y_max - det.y_min);
+			scores.push_back(det.confidence);
+			classIds.push_back(det.classId);
+			dets.push_back(&det);
+		}
+	}
+
+	std::vector<int> keep;
+	cv::dnn::NMSBoxesBatched(boxes, scores, classIds, 0.0f, TILE_NMS_IOU, keep);
+
+	CloudResult merged;
+	merged.imageWidth  = results[0].imageWidth;
+	merged.imageHeight = results[0].imageHeight;
+	merged.frameIndex  = results[0].frameIndex;
+	merged.captureNs   = results[0].captureNs;
+	merged.objects.reserve(keep.size());
+	for (int i : keep) merged.objects.push_back(*dets[i]);
+	return merged;
+}
@@ -0,0 +1,48 @@
+// UploadRegion.h : Which part of a frame is uploaded, and how the returned
+//                  boxes map back onto the frame.
+//
+// Resizing the whole frame to RESIZE_WIDTH x RESIZE_HEIGHT leaves distant
+// vehicles near the horizon a few pixels tall. With ROI_UPLOADS the agent
+// instead uploads the road band (ROI_LEFT..ROI_RIGHT, ROI_TOP..ROI_BOTTOM,
+// as fractions of the frame) at native resolution, downscaled only when it
+// is wider than ROI_MAX_WIDTH. Every ROI_FULL_EVERY-th upload is still the
+// full view. A band result only replaces the boxes inside the band:
+// keepOutside() carries the shown boxes outside it over, so signs, lights
+// and the roadside stay on screen until the next full view refreshes them.
+//
+// With TILED_UPLOADS each capture instead sends the full view plus a grid
+// of overlapping tiles over the band in one request. Each image's result
+// is mapped to frame pixels on its own, then mergeTiles() joins them and
+// drops the duplicates an object leaves in neighbouring tiles.
+//
+// Results are mapped into frame pixels as soon as they arrive (mapToFrame),
+// so the tracker and the overlay never need to know which region a result
+// came from.
+
+#pragma once
+
+#include "DriveLens.h"
+#include "Detection.h"
+#include "QualityController.h"
+
+// Region of a `frame`-sized image to upload for capture `captureIndex`.
+cv::Rect uploadRegion(cv::Size frame, uint64_t captureIndex);
+
+// Region of tile `index` (row-major, 0 .. TILE_COLS*TILE_ROWS-1).
+cv::Rect tileRegion(cv::Size frame, int index);
+
+// Upload image size for `region`, honouring the quality controller's rung.
+// Crops keep native resolution up to `maxWidth` at the full-size rung.
+cv::Size uploadSize(cv::Size frame, const cv::Rect& region,
+					const QualityController::Settings& sizing, int maxWidth);
+
+// Rewrite `result` from upload-image pixels to frame pixels.
+void mapToFrame(CloudResult& result, const cv::Rect& region, cv::Size frame);
+
+// Append the boxes of `previous` whose centre lies outside `region` to
+// `result`; both in frame pixels.
+void keepOutside(CloudResult& result, const CloudResult& previous, const cv::Rect& region);
+
+// Join per-image results already in frame pixels into one, suppressing
+// overlapping boxes of the same class. Metadata comes from results[0].
+CloudResult mergeTiles(std::vector<CloudResult>& results);
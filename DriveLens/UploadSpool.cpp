@@ -0,0 +1,295 @@
+// UploadSpool.cpp : Segment files, cursor and recovery of the upload spool.
+
+#include "UploadSpool.h"
+#include "config.h"
+
+#include <cstring>
+
+namespace fs = std::filesystem;
+
+// On-disk record header, followed by `bytes` of JPEG. Written in host byte
+// order: the spool is only ever read back on the device that wrote it.
+struct SpoolHeader {
+	char     magic[4];   // "DLS1"
+	uint32_t bytes;
+	uint64_t captureIndex;
+	int64_t  frameIndex;
+	int64_t  captureNs;
+	int64_t  wallMs;
+};
+static_assert(sizeof(SpoolHeader) == 40, "SpoolHeader must not be padded");
+
+static constexpr char     SPOOL_MAGIC[4] = { 'D', 'L', 'S', '1' };
+static constexpr char     SEGMENT_EXT[]  = ".seg";
+static constexpr char     CURSOR_FILE[]  = "cursor";
+
+UploadSpool::UploadSpool(const std::string& dir, uint64_t segmentBytes, uint64_t maxBytes)
+	: m_dir(dir), m_segmentBytes(segmentBytes), m_maxBytes(maxBytes)
+{
+	if (dir.empty()) return;
+
+	std::error_code ec;
+	fs::create_directories(m_dir, ec);
+	if (ec) {
+		std::cerr << "[Spool] Cannot create " << dir << ": " << ec.message() << std::endl;
+		return;
+	}
+
+	recover();
+	m_available = true;
+	if (!m_segments.empty())
+		std::cout << "[Spool] " << m_segments.size() << " segment(s), "
+				  << pendingBytes() / 1024 << " KB to replay" << std::endl;
+}
+
+fs::path UploadSpool::segmentPath(uint64_t seq) const
+{
+	std::string name = std::to_string(seq);
+	if (name.size() < 8) name.insert(0, 8 - name.size(), '0');
+	return m_dir / (name + SEGMENT_EXT);
+}
+
+// ── recover ──────────────────────────────────────────────────────────
+// Rebuild the segment list from the directory and resume at the cursor.
+void UploadSpool::recover()
+{
+	std::error_code ec;
+	for (const auto& entry : fs::directory_iterator(m_dir, ec)) {
+		const fs::path& path = entry.path();
+		std::string stem = path.stem().string();
+		if (path.extension() != SEGMENT_EXT || stem.empty() ||
+			stem.find_first_not_of("0123456789") != std::string::npos)
+			continue;
+		m_segments.push_back({ std::stoull(stem), entry.file_size(ec) });
+	}
+	std::sort(m_segments.begin(), m_segments.end(),
+			  [](const Segment& a, const Segment& b) { return a.seq < b.seq; });
+
+	// Only the newest segment can end in a record torn by a crash
+	if (!m_segments.empty()) {
+		Segment& last = m_segments.back();
+		uint64_t valid = validLength(segmentPath(last.seq));
+		if (valid < last.bytes) {
+			std::cerr << "[Spool] Dropping " << last.bytes - valid
+					  << " torn byte(s) from segment " << last.seq << std::endl;
+			fs::resize_file(segmentPath(last.seq), valid, ec);
+			last.bytes = valid;
+		}
+	}
+
+	// Cursor: { segment seq, offset } of the next record to replay
+	uint64_t cursor[2] = { 0, 0 };
+	fs::path cursorPath = m_dir / CURSOR_FILE;
+	m_cursor.open(cursorPath, std::ios::in | std::ios::out | std::ios::binary);
+	if (m_cursor.is_open()) {
+		m_cursor.read(reinterpret_cast<char*>(cursor), sizeof(cursor));
+		if (!m_cursor) cursor[0] = cursor[1] = 0;
+		m_cursor.clear();
+	} else {
+		m_cursor.open(cursorPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	}
+
+	// Segments wholly before the cursor were replayed before a crash
+	while (!m_segments.empty() && m_segments.front().seq < cursor[0]) {
+		fs::remove(segmentPath(m_segments.front().seq), ec);
+		m_segments.pop_front();
+	}
+	if (!m_segments.empty()) {
+		m_readSeq    = m_segments.front().seq;
+		m_readOffset = m_readSeq == cursor[0]
+					 ? std::min(cursor[1], m_segments.front().bytes) : 0;
+	} else {
+		m_readSeq    = cursor[0];
+		m_readOffset = 0;
+	}
+
+	// Appends continue in a fresh segment; the old ones are never reopened
+	// for writing, which keeps a recovered tail read-only
+	m_rotate = true;
+	saveCursor();
+	publishPending();
+}
+
+// Length of the prefix of `path` made of complete records.
+uint64_t UploadSpool::validLength(const fs::path& path) const
+{
+	std::error_code ec;
+	uint64_t size  = fs::file_size(path, ec);
+	uint64_t valid = 0;
+
+	std::ifstream in(path, std::ios::binary);
+	SpoolHeader header;
+	while (!ec && in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+		uint64_t end = valid + sizeof(header) + header.bytes;
+		if (std::memcmp(header.magic, SPOOL_MAGIC, sizeof(SPOOL_MAGIC)) != 0 || end > size)
+			break;
+		valid = end;
+		in.seekg(static_cast<std::streamoff>(valid));
+	}
+	return valid;
+}
+
+bool UploadSpool::openWriter(uint64_t seq)
+{
+	m_writer.close();
+	m_writer.clear();
+	m_writer.open(segmentPath(seq), std::ios::binary | std::ios::app);
+	if (!m_writer.is_open()) {
+		std::cerr << "[Spool] Cannot open " << segmentPath(seq).string() << std::endl;
+		return false;
+	}
+	m_segments.push_back({ seq, 0 });
+	m_rotate = false;
+	return true;
+}
+
+// ── append ───────────────────────────────────────────────────────────
+bool UploadSpool::append(const SpoolRecord& record, std::span<const uchar> jpeg)
+{
+	if (!m_available || jpeg.empty()) return false;
+
+	SpoolHeader header;
+	std::memcpy(header.magic, SPOOL_MAGIC, sizeof(SPOOL_MAGIC));
+	header.bytes        = static_cast<uint32_t>(jpeg.size());
+	header.captureIndex = record.captureIndex;
+	header.frameIndex   = record.frameIndex;
+	header.captureNs    = record.captureNs;
+	header.wallMs       = record.wallMs;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_rotate || m_segments.empty() || m_segments.back().bytes >= m_segmentBytes) {
+		// With nothing left to replay the cursor's segment is reused
+		uint64_t next = m_segments.empty() ? m_readSeq : m_segments.back().seq + 1;
+		if (!openWriter(next)) return false;
+	}
+
+	m_writer.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	m_writer.write(reinterpret_cast<const char*>(jpeg.data()),
+				   static_cast<std::streamsize>(jpeg.size()));
+	m_writer.flush();
+	if (!m_writer) {
+		// The segment may now end in a partial record: never append after it
+		std::cerr << "[Spool] Write failed for frame " << record.captureIndex << std::endl;
+		m_rotate = true;
+		return false;
+	}
+
+	m_segments.back().bytes += sizeof(header) + jpeg.size();
+	m_spooled.fetch_add(1, std::memory_order_relaxed);
+	trim();
+	publishPending();
+	return true;
+}
+
+// ── peek ─────────────────────────────────────────────────────────────
+bool UploadSpool::peek(SpoolRecord& record, std::vector<uchar>& jpeg)
+{
+	if (!m_available) return false;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_peekBytes = 0;
+	while (!m_segments.empty()) {
+		const Segment& segment = m_segments.front();
+		if (m_readOffset >= segment.bytes) {
+			// The segment still being written may grow; any other is done
+			bool writing = m_segments.size() == 1 && !m_rotate;
+			if (writing) return false;
+			advanceSegment();
+			continue;
+		}
+
+		if (!m_reader.is_open()) m_reader.open(segmentPath(segment.seq), std::ios::binary);
+		m_reader.clear();
+		m_reader.seekg(static_cast<std::streamoff>(m_readOffset));
+
+		SpoolHeader header;
+		bool ok = static_cast<bool>(m_reader.read(reinterpret_cast<char*>(&header), sizeof(header)))
+			   && std::memcmp(header.magic, SPOOL_MAGIC, sizeof(SPOOL_MAGIC)) == 0
+			   && m_readOffset + sizeof(header) + header.bytes <= segment.bytes;
+		if (ok) {
+			jpeg.resize(header.bytes);
+			ok = static_cast<bool>(m_reader.read(reinterpret_cast<char*>(jpeg.data()),
+												 header.bytes));
+		}
+		if (!ok) {
+			std::cerr << "[Spool] Corrupt record in segment " << segment.seq
+					  << " at " << m_readOffset << ", skipping the rest" << std::endl;
+			m_droppedBytes.fetch_add(segment.bytes - m_readOffset, std::memory_order_relaxed);
+			m_readOffset = segment.bytes;
+			m_rotate     = true;   // do not append behind the damage
+			publishPending();
+			continue;
+		}
+
+		record.captureIndex = header.captureIndex;
+		record.frameIndex   = header.frameIndex;
+		record.captureNs    = header.captureNs;
+		record.wallMs       = header.wallMs;
+		m_peekBytes = sizeof(header) + header.bytes;
+		return true;
+	}
+	return false;
+}
+
+// ── commit ───────────────────────────────────────────────────────────
+void UploadSpool::commit(bool delivered)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_peekBytes == 0) return;   // trimmed away since peek()
+	m_readOffset += m_peekBytes;
+	m_peekBytes   = 0;
+	(delivered ? m_replayed : m_rejected).fetch_add(1, std::memory_order_relaxed);
+	saveCursor();
+	publishPending();
+}
+
+// Delete the front segment and move the cursor to the next one.
+void UploadSpool::advanceSegment()
+{
+	std::error_code ec;
+	m_reader.close();
+	if (m_segments.size() == 1) m_writer.close();
+	fs::remove(segmentPath(m_segments.front().seq), ec);
+	m_segments.pop_front();
+
+	m_readSeq    = m_segments.empty() ? m_readSeq + 1 : m_segments.front().seq;
+	m_readOffset = 0;
+	m_peekBytes  = 0;
+	saveCursor();
+	publishPending();
+}
+
+// Drop the oldest segments while over SPOOL_MAX_BYTES. The segment being
+// written is always kept.
+void UploadSpool::trim()
+{
+	while (m_segments.size() > 1) {
+		uint64_t total = 0;
+		for (const Segment& segment : m_segments) total += segment.bytes;
+		if (total - m_readOffset <= m_maxBytes) break;
+
+		uint64_t lost = m_segments.front().bytes - m_readOffset;
+		std::cerr << "[Spool] Full, dropping " << lost / 1024 << " KB of segment "
+				  << m_segments.front().seq << std::endl;
+		m_droppedBytes.fetch_add(lost, std::memory_order_relaxed);
+		advanceSegment();
+	}
+}
+
+void UploadSpool::saveCursor()
+{
+	uint64_t cursor[2] = { m_readSeq, m_readOffset };
+	m_cursor.clear();
+	m_cursor.seekp(0);
+	m_cursor.write(reinterpret_cast<const char*>(cursor), sizeof(cursor));
+	m_cursor.flush();
+}
+
+// Recompute the unreplayed byte count for lock-free readers. Called with
+// m_mutex held after anything that moves the segments or the cursor.
+void UploadSpool::publishPending()
+{
+	uint64_t total = 0;
+	for (const Segment& segment : m_segments) total += segment.bytes;
+	m_pendingBytes.store(total - std::min(total, m_readOffset), std::memory_order_relaxed);
+}
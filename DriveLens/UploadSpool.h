@@ -0,0 +1,94 @@
+// UploadSpool.h : Bounded on-disk queue of encoded frames that still have
+//                 to reach the server.
+//
+// Records (a fixed header with the capture metadata, then the JPEG bytes)
+// are appended to numbered segment files of about SPOOL_SEGMENT_BYTES in
+// the spool directory, and read back in order by the replay drainer. The
+// read position is kept in a small cursor file, so a restart resumes where
+// the last replay stopped: only the handful of segment names is listed and
+// only the newest segment is walked, to cut off a record torn by a crash.
+// Fully replayed segments are deleted; past SPOOL_MAX_BYTES the oldest
+// segment is dropped unreplayed.
+//
+// append() may be called from any upload worker; peek()/commit() from the
+// drainer only. The statistics are atomics, published after every change,
+// so the stats line and the metrics endpoint never wait on m_mutex, which
+// append() holds across the disk write and flush.
+
+#pragma once
+
+#include "DriveLens.h"
+
+#include <deque>
+#include <fstream>
+
+struct SpoolRecord {
+	uint64_t captureIndex = 0;
+	int64_t  frameIndex   = -1;
+	int64_t  captureNs    = 0;
+	int64_t  wallMs       = 0;   // system_clock time of the capture
+};
+
+class UploadSpool {
+public:
+	// An empty `dir` disables the spool (available() == false).
+	UploadSpool(const std::string& dir, uint64_t segmentBytes, uint64_t maxBytes);
+
+	UploadSpool(const UploadSpool&)            = delete;
+	UploadSpool& operator=(const UploadSpool&) = delete;
+
+	bool available() const { return m_available; }
+
+	// Append one frame; false if the spool is disabled or the write failed.
+	bool append(const SpoolRecord& record, std::span<const uchar> jpeg);
+
+	// Oldest unreplayed record, without consuming it. False when empty.
+	bool peek(SpoolRecord& record, std::vector<uchar>& jpeg);
+
+	// Consume the record returned by the last peek(); `delivered` false
+	// when it is given up on instead (counted in rejected()).
+	void commit(bool delivered = true);
+
+	// ── Statistics (any thread) ──────────────────────────────────────
+	uint64_t pendingBytes() const { return m_pendingBytes.load(std::memory_order_relaxed); }
+	uint64_t spooled()      const { return m_spooled.load(std::memory_order_relaxed); }
+	uint64_t replayed()     const { return m_replayed.load(std::memory_order_relaxed); }
+	uint64_t rejected()     const { return m_rejected.load(std::memory_order_relaxed); }
+	uint64_t droppedBytes() const { return m_droppedBytes.load(std::memory_order_relaxed); }
+
+private:
+	struct Segment {
+		uint64_t seq   = 0;
+		uint64_t bytes = 0;
+	};
+
+	std::filesystem::path segmentPath(uint64_t seq) const;
+	void     recover();
+	uint64_t validLength(const std::filesystem::path& path) const;
+	bool     openWriter(uint64_t seq);
+	void     advanceSegment();
+	void     trim();
+	void     saveCursor();
+	void     publishPending();
+
+	bool                  m_available = false;
+	std::filesystem::path m_dir;
+	uint64_t              m_segmentBytes;
+	uint64_t              m_maxBytes;
+
+	mutable std::mutex  m_mutex;
+	std::deque<Segment> m_segments;        // front is being read, back written
+	std::ofstream       m_writer;
+	bool                m_rotate     = false;   // start a new segment on next append
+	std::ifstream       m_reader;
+	uint64_t            m_readSeq    = 0;
+	uint64_t            m_readOffset = 0;
+	uint64_t            m_peekBytes  = 0;       // size of the record handed out by peek()
+	std::fstream        m_cursor;
+
+	std::atomic<uint64_t> m_pendingBytes{ 0 };   // unreplayed bytes, see publishPending()
+	std::atomic<uint64_t> m_spooled{ 0 };
+	std::atomic<uint64_t> m_replayed{ 0 };
+	std::atomic<uint64_t> m_rejected{ 0 };
+	std::atomic<uint64_t> m_droppedBytes{ 0 };
+};
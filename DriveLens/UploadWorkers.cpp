@@ -0,0 +1,70 @@
+// UploadWorkers.cpp : Worker threads for concurrent uploads.
+
+#include "UploadWorkers.h"
+
+UploadWorkers::UploadWorkers(size_t window, Handler handler)
+	: m_window(window > 0 ? window : 1),
+	  m_handler(std::move(handler)),
+	  m_jobs(m_window),
+	  m_results(m_window)
+{
+	m_workers.reserve(m_window);
+	for (size_t i = 0; i < m_window; ++i)
+		m_workers.emplace_back([this] { workerLoop(); });
+}
+
+UploadWorkers::~UploadWorkers()
+{
+	shutdown();
+}
+
+bool UploadWorkers::trySubmit(UploadJob&& job)
+{
+	if (m_inFlight.load(std::memory_order_relaxed) >= m_window) return false;
+	if (!m_jobs.tryPush(std::move(job))) return false;
+	m_inFlight.fetch_add(1, std::memory_order_relaxed);
+	return true;
+}
+
+bool UploadWorkers::poll(UploadResult& result)
+{
+	if (!m_results.tryPop(result)) return false;
+	m_inFlight.fetch_sub(1, std::memory_order_relaxed);
+	return true;
+}
+
+void UploadWorkers::wait(UploadResult& result)
+{
+	m_results.pop(result);
+	m_inFlight.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void UploadWorkers::shutdown()
+{
+	m_jobs.close();
+	for (auto& worker : m_workers)
+		if (worker.joinable()) worker.join();
+}
+
+void UploadWorkers::workerLoop()
+{
+	UploadJob job;
+	while (m_jobs.pop(job)) {
+		UploadResult result;
+		result.captureIndex = job.captureIndex;
+		result.captureNs    = job.captureNs;
+		result.region       = job.region;
+		try {
+			result.result = m_handler(job);
+		} catch (const std::exception& ex) {
+			std::cerr << "[Upload] " << job.filename
+					  << "  worker error: " << ex.what() << std::endl;
+		}
+
+		// Give the encode buffer back before the result becomes visible
+		job.buffer.reset();
+
+		// Cannot be full: results are bounded by the in-flight window
+		m_results.tryPush(std::move(result));
+	}
+}
@@ -0,0 +1,74 @@
+// UploadWorkers.h : Fixed pool of upload threads with a bounded in-flight
+//                   window.
+//
+// The pipeline thread submits one UploadJob per sampled frame; a worker
+// runs the detection handler (encode + upload + parse, or local inference)
+// and posts an UploadResult tagged with the job's capture index. A job
+// counts as in flight from submit() until its result is collected with
+// poll(), so the caller can keep at most `window` requests outstanding.
+// submit() and poll() are meant to be called from the pipeline thread only.
+
+#pragma once
+
+#include "DriveLens.h"
+#include "BoundedQueue.h"
+#include "BufferPool.h"
+#include "Detection.h"
+
+struct UploadJob {
+	uint64_t          captureIndex = 0;
+	uint64_t          frameIndex   = 0;   // source frame the sample came from
+	int64_t           captureNs    = 0;   // monotonicNs() when it was decoded
+	BufferPool::Lease buffer;     // returned to the pool once the job is done
+	std::string       filename;
+	int               quality      = JPEG_QUALITY;
+	int               rung         = 0;   // QualityController rung it was sized at
+	cv::Rect          region;             // part of the frame that was uploaded
+	cv::Size          frameSize;
+};
+
+struct UploadResult {
+	uint64_t    captureIndex = 0;
+	int64_t     captureNs    = 0;
+	cv::Rect    region;           // part of the frame the result covers
+	CloudResult result;           // empty when detection failed
+};
+
+class UploadWorkers {
+public:
+	using Handler = std::function<CloudResult(UploadJob&)>;
+
+	UploadWorkers(size_t window, Handler handler);
+	~UploadWorkers();
+
+	UploadWorkers(const UploadWorkers&)            = delete;
+	UploadWorkers& operator=(const UploadWorkers&) = delete;
+
+	// Queue a job if the in-flight window has room. Returns false (and
+	// leaves `job` untouched) when the window is full.
+	bool trySubmit(UploadJob&& job);
+
+	// Collect one finished result without blocking.
+	bool poll(UploadResult& result);
+
+	// Block until the next result is available. Only call with at least
+	// one job in flight.
+	void wait(UploadResult& result);
+
+	// Finish every queued job and stop the workers. Results that were not
+	// polled are discarded.
+	void shutdown();
+
+	size_t window()   const { return m_window; }
+	size_t inFlight() const { return m_inFlight.load(std::memory_order_relaxed); }
+
+private:
+	void workerLoop();
+
+	size_t                     m_window;
+	Handler                    m_handler;
+	BoundedQueue<UploadJob>    m_jobs;
+	BoundedQueue<UploadResult> m_results;
+	std::atomic<size_t>        m_inFlight{ 0 };
+	std::vector<std::jthread>  m_workers;
+};
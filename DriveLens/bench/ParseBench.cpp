@@ -0,0 +1,192 @@
+// ParseBench.cpp : Microbenchmark for the detection response parsers.
+//
+// Builds a server-shaped /upload response with N detections and times the
+// DOM parser against the streaming SAX parser and the compact binary
+// decoder, reporting time per parse and heap allocations per parse
+// (counted by the operator new below).
+//
+// Usage:
+//   ParseBench [detections=60] [iterations=20000]
+
+#include "../CloudResponse.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// ── Allocation counter ───────────────────────────────────────────────
+// Every form of operator new/delete is replaced so that each allocation is
+// counted and malloc always pairs with free. Aligned blocks over-allocate
+// and keep the malloc'ed pointer just in front of the aligned one.
+static std::atomic<uint64_t> g_allocations{ 0 };
+
+static void* allocate(std::size_t size, std::size_t align = 0)
+{
+	g_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (align <= alignof(std::max_align_t)) return std::malloc(size ? size : 1);
+
+	void* raw = std::malloc(size + align + sizeof(void*));
+	if (!raw) return nullptr;
+	auto  at      = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+	void* aligned = reinterpret_cast<void*>((at + align - 1) & ~(align - 1));
+	static_cast<void**>(aligned)[-1] = raw;
+	return aligned;
+}
+
+static void release(void* p, std::size_t align = 0) noexcept
+{
+	if (!p) return;
+	std::free(align <= alignof(std::max_align_t) ? p : static_cast<void**>(p)[-1]);
+}
+
+static void* allocateOrThrow(std::size_t size, std::size_t align = 0)
+{
+	if (void* p = allocate(size, align)) return p;
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size)                                    { return allocateOrThrow(size); }
+void* operator new[](std::size_t size)                                  { return allocateOrThrow(size); }
+void* operator new(std::size_t size, std::align_val_t al)               { return allocateOrThrow(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al)             { return allocateOrThrow(size, static_cast<std::size_t>(al)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept    { return allocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept  { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept   { return allocate(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return allocate(size, static_cast<std::size_t>(al)); }
+
+void operator delete(void* p) noexcept                                  { release(p); }
+void operator delete[](void* p) noexcept                                { release(p); }
+void operator delete(void* p, std::size_t) noexcept                     { release(p); }
+void operator delete[](void* p, std::size_t) noexcept                   { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept           { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept         { release(p); }
+void operator delete(void* p, std::align_val_t al) noexcept             { release(p, static_cast<std::size_t>(al)); }
+void operator delete[](void* p, std::align_val_t al) noexcept           { release(p, static_cast<std::size_t>(al)); }
+void operator delete(void* p, std::size_t, std::align_val_t al) noexcept   { release(p, static_cast<std::size_t>(al)); }
+void operator delete[](void* p, std::size_t, std::align_val_t al) noexcept { release(p, static_cast<std::size_t>(al)); }
+void operator delete(void* p, std::align_val_t al, const std::nothrow_t&) noexcept   { release(p, static_cast<std::size_t>(al)); }
+void operator delete[](void* p, std::align_val_t al, const std::nothrow_t&) noexcept { release(p, static_cast<std::size_t>(al)); }
+
+static const int   classIds[] = { 0, 1, 2, 3, 5, 7, 9, 11 };
+static const char* names[]    = { "person", "bicycle", "car", "motorcycle",
+								  "bus", "truck", "traffic light", "stop sign" };
+
+static std::string makeResponse(int detections)
+{
+	nlohmann::json objects = nlohmann::json::array();
+	for (int i = 0; i < detections; ++i) {
+		objects.push_back({
+			{ "name",       names[i % 8] },
+			{ "class_id",   classIds[i % 8] },
+			{ "confidence", 0.4f + (i % 60) / 100.0f },
+			{ "x_min",      (i * 37) % 600 },
+			{ "y_min",      (i * 53) % 440 },
+			{ "x_max",      (i * 37) % 600 + 40 },
+			{ "y_max",      (i * 53) % 440 + 40 },
+		});
+	}
+	nlohmann::json j = {
+		{ "status",           "ok" },
+		{ "filename",         "frame_42.jpg" },
+		{ "size_bytes",       48213 },
+		{ "image_width",      640 },
+		{ "image_height",     480 },
+		{ "detected_objects", objects },
+		{ "db_id",            1234 },
+		{ "frame_index",      4242 },
+		{ "capture_ns",       123456789012345 },
+	};
+	return j.dump();
+}
+
+// Same result in the binary layout (see CloudResponse.h)
+static std::string makeBinaryResponse(int detections)
+{
+	std::string out;
+	auto put = [&](uint64_t v, int bytes) {
+		for (int b = 0; b < bytes; ++b) out.push_back(static_cast<char>((v >> (8 * b)) & 0xFF));
+	};
+	out += "DLD1";
+	put(640, 2);
+	put(480, 2);
+	put(4242, 8);
+	put(123456789012345, 8);
+	put(detections, 2);
+	for (int i = 0; i < detections; ++i) {
+		put(classIds[i % 8], 1);
+		put(static_cast<uint64_t>(std::lround((0.4f + (i % 60) / 100.0f) * 65535)), 2);
+		put((i * 37) % 600, 2);
+		put((i * 53) % 440, 2);
+		put((i * 37) % 600 + 40, 2);
+		put((i * 53) % 440 + 40, 2);
+	}
+	return out;
+}
+
+// Confidence is quantized to 1/65535 in the binary format
+static bool sameResult(const CloudResult& a, const CloudResult& b)
+{
+	bool same = a.objects.size() == b.objects.size() &&
+				a.imageWidth == b.imageWidth && a.imageHeight == b.imageHeight &&
+				a.frameIndex == b.frameIndex && a.captureNs == b.captureNs;
+	for (size_t i = 0; same && i < a.objects.size(); ++i) {
+		const Detection& x = a.objects[i];
+		const Detection& y = b.objects[i];
+		same = x.classId == y.classId && std::abs(x.confidence - y.confidence) < 1e-4f &&
+			   x.x_min == y.x_min && x.y_min == y.y_min &&
+			   x.x_max == y.x_max && x.y_max == y.y_max;
+	}
+	return same;
+}
+
+template <typename Parse>
+static void run(const char* label, Parse parse, const std::string& body, int iterations)
+{
+	size_t checksum = 0;
+	for (int i = 0; i < iterations / 10; ++i)   // warm-up
+		checksum += parse(body).objects.size();
+
+	uint64_t allocsBefore = g_allocations.load();
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; ++i)
+		checksum += parse(body).objects.size();
+	double ns = std::chrono::duration<double, std::nano>(
+		std::chrono::steady_clock::now() - start).count();
+	uint64_t allocs = g_allocations.load() - allocsBefore;
+
+	std::cout << "  " << label
+			  << "  " << ns / iterations / 1000.0 << " us/parse"
+			  << "  " << (body.size() * iterations) / (ns / 1e9) / (1024 * 1024) << " MB/s"
+			  << "  " << static_cast<double>(allocs) / iterations << " allocs/parse"
+			  << "  (checksum " << checksum << ")" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	int detections = argc > 1 ? std::atoi(argv[1]) : 60;
+	int iterations = argc > 2 ? std::atoi(argv[2]) : 20000;
+
+	std::string body   = makeResponse(detections);
+	std::string binary = makeBinaryResponse(detections);
+
+	// All parsers must agree before their timings mean anything
+	CloudResult dom = parseCloudResponseDom(body);
+	if (!sameResult(dom, parseCloudResponse(body))) {
+		std::cerr << "[Bench] DOM and SAX results differ" << std::endl;
+		return 1;
+	}
+	if (!sameResult(dom, parseCloudResponse(binary))) {
+		std::cerr << "[Bench] DOM and binary results differ" << std::endl;
+		return 1;
+	}
+
+	std::cout << "[Bench] " << detections << " detections, " << body.size()
+			  << " bytes JSON / " << binary.size() << " bytes binary, "
+			  << iterations << " iterations" << std::endl;
+	run("DOM", parseCloudResponseDom, body,   iterations);
+	run("SAX", parseCloudResponse,    body,   iterations);
+	run("BIN", parseCloudResponse,    binary, iterations);
+	return 0;
+}
@@ -3,15 +3,120 @@
 // ── Server ────────────────────────────────────────────────────────────
 constexpr const char* API_ENDPOINT         = "http://localhost:8000/upload";
 constexpr int         UPLOAD_TIMEOUT_MS    = 30000;
+constexpr int         UPLOAD_CONNECT_MS    = 5000;
+constexpr int         UPLOAD_IN_FLIGHT     = 3;     // max outstanding upload requests
+constexpr int         UPLOAD_POOL_SIZE     = UPLOAD_IN_FLIGHT + 1;  // keep-alive sessions, +1 for spool replay
+constexpr int         UPLOAD_KEEPALIVE_SEC = 30;    // idle time before TCP probes
 
 // ── Capture ───────────────────────────────────────────────────────────
-constexpr int         CAPTURE_INTERVAL_SEC = 2;
+constexpr int         CAPTURE_INTERVAL_SEC = 2;     // nominal gap between uploads
+
+// Scene-change gating: upload sooner when the view changes a lot, only
+// every CAPTURE_MAX_MS when it does not. Set false for a fixed interval.
+constexpr bool        CAPTURE_CHANGE_GATED = true;
+constexpr int         CAPTURE_MIN_MS       = 500;   // fastest upload rate
+constexpr int         CAPTURE_MAX_MS       = 10000; // heartbeat for static scenes
+constexpr int         CHANGE_PROBE_MS      = 200;   // how often the scene is scored
+constexpr double      CHANGE_LOW           = 4.0;   // mean abs diff (0-255): "unchanged"
+constexpr double      CHANGE_HIGH          = 20.0;  // at/above: sample at CAPTURE_MIN_MS
+constexpr int         CHANGE_THUMB_WIDTH   = 64;
+constexpr int         CHANGE_THUMB_HEIGHT  = 48;
+
+// ── Pipeline ──────────────────────────────────────────────────────────
+constexpr int         FRAME_RING_CAPACITY  = 4;     // preallocated frame slots
+constexpr int         STATS_INTERVAL_SEC   = 10;    // pipeline counter log period
+constexpr const char* LATENCY_DUMP_PATH    = "latency.json";  // per-stage histograms, rewritten each period
+constexpr int         METRICS_PORT         = 9464;  // Prometheus /metrics on 127.0.0.1 (0 = off)
 
 // ── Image ─────────────────────────────────────────────────────────────
 constexpr int         RESIZE_WIDTH         = 640;
 constexpr int         RESIZE_HEIGHT        = 480;
-constexpr int         JPEG_QUALITY         = 80;
+constexpr int         JPEG_QUALITY         = 80;    // also the adaptive maximum
+constexpr int         ENCODE_BUFFER_COUNT  = UPLOAD_IN_FLIGHT + 1;  // pooled encode buffers
+constexpr int         ENCODE_RESERVE_BYTES = 256 * 1024;  // reserved per JPEG buffer
+
+// Adaptive upload size: quality, then resolution, step down while uploads
+// take longer than UPLOAD_TARGET_MS and back up when the link recovers
+constexpr bool        ADAPTIVE_QUALITY     = true;
+constexpr int         JPEG_QUALITY_MIN     = 40;
+constexpr int         ADAPT_QUALITY_STEP   = 10;
+constexpr double      ADAPT_MIN_SCALE      = 0.5;   // smallest size, x RESIZE_*
+constexpr int         UPLOAD_TARGET_MS     = 600;   // round trip to hold
+constexpr int         ADAPT_SAMPLES        = 3;     // uploads per decision
+constexpr double      QUALITY_EWMA_ALPHA   = 0.2;   // RTT / throughput smoothing
+
+// ── Region of interest ────────────────────────────────────────────────
+// Upload the road band at native resolution instead of the whole frame
+// resized; every ROI_FULL_EVERY-th upload is still the full view
+constexpr bool        ROI_UPLOADS          = true;
+constexpr double      ROI_LEFT             = 0.10;  // band, as fractions of the frame
+constexpr double      ROI_RIGHT            = 0.90;
+constexpr double      ROI_TOP              = 0.35;
+constexpr double      ROI_BOTTOM           = 0.70;
+constexpr int         ROI_MAX_WIDTH        = 1024;  // wider crops are downscaled
+constexpr int         ROI_FULL_EVERY       = 4;
+
+// ── Tiled uploads ─────────────────────────────────────────────────────
+// Send the full view plus a TILE_COLS x TILE_ROWS grid over the road band
+// (the whole frame without ROI_UPLOADS) in one request; the server runs
+// them as one batch and the tiles are merged with cross-tile NMS
+constexpr bool        TILED_UPLOADS        = false;
+constexpr int         TILE_COLS            = 2;
+constexpr int         TILE_ROWS            = 2;
+constexpr int         TILE_OVERLAP         = 32;    // px, so edge objects land whole in a tile
+constexpr int         TILE_MAX_WIDTH       = 640;   // wider tiles are downscaled
+constexpr float       TILE_NMS_IOU         = 0.45f;
+
+// ── Offline spool ─────────────────────────────────────────────────────
+// Failed uploads, and captures handled locally while the cloud is down,
+// are appended to segment files in SPOOL_DIR and replayed in the
+// background once the server answers again
+constexpr bool        SPOOL_ENABLED        = true;
+constexpr const char* SPOOL_DIR            = "spool";
+constexpr int64_t     SPOOL_SEGMENT_BYTES  = 16LL * 1024 * 1024;   // per segment file
+constexpr int64_t     SPOOL_MAX_BYTES      = 512LL * 1024 * 1024;  // oldest segment dropped beyond
+constexpr double      SPOOL_REPLAY_PER_SEC = 2.0;   // replay rate limit
+constexpr int         SPOOL_RETRY_MIN_MS   = 2000;  // backoff after a failed replay
+constexpr int         SPOOL_RETRY_MAX_MS   = 60000;
+constexpr int         SPOOL_MAX_ATTEMPTS   = 5;     // 5xx answers before a record is dropped
+constexpr int         SPOOL_IDLE_MS        = 1000;  // poll period while empty
+
+// ── Detection log ─────────────────────────────────────────────────────
+// Every detection, appended to a fixed-record binary file for analysis on
+// the vehicle (tools/DetectionQuery). Empty path disables it
+constexpr const char* DETECTION_LOG_PATH   = "detections.dlg";
+constexpr int         DETECTION_LOG_QUEUE  = 4096;  // records buffered for the writer
+constexpr int         DETECTION_LOG_BATCH  = 256;   // max records per write
+
+// ── Local inference fallback ──────────────────────────────────────────
+// YOLOv8 ONNX export run with OpenCV DNN when the cloud fails or is slower
+constexpr bool        LOCAL_FALLBACK       = true;
+constexpr const char* LOCAL_MODEL_PATH     = "yolov8n.onnx";
+constexpr int         LOCAL_INPUT_SIZE     = 320;   // must match the export imgsz
+constexpr float       LOCAL_CONF_THRESHOLD = 0.40f; // same as the server
+constexpr float       LOCAL_NMS_THRESHOLD  = 0.45f;
+constexpr int         FALLBACK_FAILURES    = 2;     // consecutive cloud failures
+constexpr int         CLOUD_SLOW_MS        = 800;   // cloud RTT considered degraded
+constexpr int         CLOUD_PROBE_MS       = 5000;  // retry cloud while on local
+constexpr double      POLICY_EWMA_ALPHA    = 0.2;
+
+// ── Response parsing ──────────────────────────────────────────────────
+constexpr bool        BINARY_RESPONSE      = true;  // ask for the compact format
+constexpr int         PARSE_RESERVE        = 64;    // detections reserved per parse
+
+// ── Tracking ──────────────────────────────────────────────────────────
+// Optical-flow tracking of the last detections between cloud results
+constexpr bool        TRACK_ENABLED        = true;
+constexpr int         TRACK_WIDTH          = 320;   // tracker working resolution
+constexpr int         TRACK_HEIGHT         = 240;
+constexpr int         TRACK_POINTS_PER_BOX = 12;
+constexpr int         TRACK_MIN_POINTS     = 3;     // below this a box is re-seeded
+constexpr int         TRACK_WINDOW         = 15;    // Lucas-Kanade window (px)
+constexpr int         TRACK_PYR_LEVELS     = 3;     // covers the jump from capture to now
+constexpr int         TRACK_HISTORY        = UPLOAD_IN_FLIGHT + 1;  // capture snapshots
 
 // ── Debug ─────────────────────────────────────────────────────────────
 #define DEBUG_SAVE_FRAMES
-constexpr const char* DEBUG_OUTPUT_DIR     = "debug_frames";
+constexpr const char* DEBUG_OUTPUT_DIR     = "debug_frames";   // archive_*.dla / .dli
+constexpr int64_t     DEBUG_ARCHIVE_BYTES  = 256LL * 1024 * 1024;  // per archive segment
+constexpr int         DEBUG_QUEUE_DEPTH    = 8;     // frames buffered for the writer
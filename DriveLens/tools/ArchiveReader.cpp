@@ -0,0 +1,169 @@
+// ArchiveReader.cpp : Lists and extracts frames of a debug frame archive.
+//
+// Frame numbers run across all segments in order. Only the index sizes are
+// read to find the segment holding frame N; its index and data files are
+// then memory-mapped and the frame is one entry lookup away.
+//
+// Usage:
+//   ArchiveReader <dir>                  summary of the archive
+//   ArchiveReader <dir> list             one line per frame
+//   ArchiveReader <dir> <N> [out.jpg]    write frame N (default frame_N.jpg)
+
+#include "../DebugArchive.h"
+#include "MappedFile.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+struct SegmentInfo {
+	uint64_t seq    = 0;
+	uint64_t frames = 0;
+};
+
+// Segments with their frame counts, from the index file sizes alone.
+static std::vector<SegmentInfo> scanSegments(const fs::path& dir)
+{
+	std::vector<SegmentInfo> segments;
+	for (uint64_t seq : archiveSegments(dir)) {
+		std::error_code ec;
+		uint64_t size = fs::file_size(archivePath(dir, seq, ".dli"), ec);
+		if (ec || size < sizeof(ArchiveFileHeader)) continue;
+		segments.push_back({ seq, (size - sizeof(ArchiveFileHeader)) / sizeof(ArchiveIndexEntry) });
+	}
+	return segments;
+}
+
+// Mapped index + data of one segment.
+struct OpenSegment {
+	MappedFile index;
+	MappedFile data;
+
+	bool open(const fs::path& dir, uint64_t seq)
+	{
+		if (!index.open(archivePath(dir, seq, ".dli")) ||
+			!data.open(archivePath(dir, seq, ".dla")))
+			return false;
+		return hasMagic(index, ARCHIVE_INDEX_MAGIC) && hasMagic(data, ARCHIVE_DATA_MAGIC);
+	}
+
+	uint64_t frames() const
+	{
+		return (index.size() - sizeof(ArchiveFileHeader)) / sizeof(ArchiveIndexEntry);
+	}
+
+	ArchiveIndexEntry entry(uint64_t i) const
+	{
+		ArchiveIndexEntry e;
+		std::memcpy(&e, index.bytes().data() + sizeof(ArchiveFileHeader) + i * sizeof(e),
+					sizeof(e));
+		return e;
+	}
+
+	// JPEG bytes of entry `e`, or empty if it points outside the data file.
+	std::span<const uint8_t> frame(const ArchiveIndexEntry& e) const
+	{
+		if (e.offset > data.size() || e.bytes > data.size() - e.offset) return {};
+		return data.bytes().subspan(e.offset, e.bytes);
+	}
+
+private:
+	static bool hasMagic(const MappedFile& file, const char (&magic)[4])
+	{
+		ArchiveFileHeader header;
+		if (file.size() < sizeof(header)) return false;
+		std::memcpy(&header, file.bytes().data(), sizeof(header));
+		return std::memcmp(header.magic, magic, sizeof(header.magic)) == 0
+			&& header.version == ARCHIVE_VERSION;
+	}
+};
+
+static int summary(const fs::path& dir, const std::vector<SegmentInfo>& segments)
+{
+	uint64_t total = 0;
+	for (const SegmentInfo& s : segments) total += s.frames;
+	std::cout << dir.string() << ": " << segments.size() << " segment(s), "
+			  << total << " frame(s)" << std::endl;
+	for (const SegmentInfo& s : segments)
+		std::cout << "  " << archivePath(dir, s.seq, ".dla").filename().string()
+				  << "  " << s.frames << " frame(s)" << std::endl;
+	return 0;
+}
+
+static int list(const fs::path& dir, const std::vector<SegmentInfo>& segments)
+{
+	uint64_t n = 0;
+	for (const SegmentInfo& s : segments) {
+		OpenSegment segment;
+		if (!segment.open(dir, s.seq)) {
+			std::cerr << "Cannot read segment " << s.seq << std::endl;
+			n += s.frames;
+			continue;
+		}
+		for (uint64_t i = 0; i < segment.frames(); ++i, ++n) {
+			ArchiveIndexEntry e = segment.entry(i);
+			std::cout << n << "\tcapture=" << e.captureIndex << "\twall_ms=" << e.wallMs
+					  << "\tbytes=" << e.bytes << std::endl;
+		}
+	}
+	return 0;
+}
+
+static int extract(const fs::path& dir, const std::vector<SegmentInfo>& segments,
+				   uint64_t n, std::string out)
+{
+	uint64_t first = 0;
+	for (const SegmentInfo& s : segments) {
+		if (n >= first + s.frames) {
+			first += s.frames;
+			continue;
+		}
+
+		OpenSegment segment;
+		if (!segment.open(dir, s.seq)) {
+			std::cerr << "Cannot read segment " << s.seq << std::endl;
+			return 1;
+		}
+		ArchiveIndexEntry e = segment.entry(n - first);
+		std::span<const uint8_t> jpeg = segment.frame(e);
+		if (jpeg.empty()) {
+			std::cerr << "Frame " << n << " points outside the data file" << std::endl;
+			return 1;
+		}
+
+		if (out.empty()) out = "frame_" + std::to_string(n) + ".jpg";
+		std::ofstream file(out, std::ios::binary);
+		file.write(reinterpret_cast<const char*>(jpeg.data()),
+				   static_cast<std::streamsize>(jpeg.size()));
+		if (!file) {
+			std::cerr << "Cannot write " << out << std::endl;
+			return 1;
+		}
+		std::cout << out << ": capture=" << e.captureIndex << " wall_ms=" << e.wallMs
+				  << " bytes=" << e.bytes << std::endl;
+		return 0;
+	}
+	std::cerr << "Frame " << n << " out of range (" << first << " frames)" << std::endl;
+	return 1;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2) {
+		std::cerr << "Usage: ArchiveReader <dir> [list | <N> [out.jpg]]" << std::endl;
+		return 1;
+	}
+
+	fs::path dir = argv[1];
+	std::vector<SegmentInfo> segments = scanSegments(dir);
+	if (argc == 2) return summary(dir, segments);
+
+	std::string arg = argv[2];
+	if (arg == "list") return list(dir, segments);
+	if (arg.empty() || arg.find_first_not_of("0123456789") != std::string::npos) {
+		std::cerr << "Frame number expected, got " << arg << std::endl;
+		return 1;
+	}
+	return extract(dir, segments, std::stoull(arg), argc > 3 ? argv[3] : "");
+}
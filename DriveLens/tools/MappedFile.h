@@ -0,0 +1,88 @@
+// MappedFile.h : Read-only memory mapping of a whole file, for the offline
+//                tools that read the edge agent's archives and logs.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class MappedFile {
+public:
+	MappedFile() = default;
+	explicit MappedFile(const std::filesystem::path& path) { open(path); }
+	~MappedFile() { close(); }
+
+	MappedFile(MappedFile&& other) noexcept
+		: m_data(std::exchange(other.m_data, nullptr)),
+		  m_size(std::exchange(other.m_size, 0)) {}
+	MappedFile(const MappedFile&)            = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// False if the file is missing, empty or cannot be mapped.
+	bool open(const std::filesystem::path& path)
+	{
+		close();
+#ifdef _WIN32
+		HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+								  nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER size{};
+		if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+			HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping) {
+				m_data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+				if (m_data) m_size = static_cast<size_t>(size.QuadPart);
+				CloseHandle(mapping);
+			}
+		}
+		CloseHandle(file);
+#else
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st{};
+		if (fstat(fd, &st) == 0 && st.st_size > 0) {
+			void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+			if (p != MAP_FAILED) {
+				m_data = static_cast<const uint8_t*>(p);
+				m_size = static_cast<size_t>(st.st_size);
+			}
+		}
+		::close(fd);
+#endif
+		return m_data != nullptr;
+	}
+
+	void close()
+	{
+		if (!m_data) return;
+#ifdef _WIN32
+		UnmapViewOfFile(m_data);
+#else
+		munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+		m_data = nullptr;
+		m_size = 0;
+	}
+
+	std::span<const uint8_t> bytes() const { return { m_data, m_size }; }
+	size_t                   size()  const { return m_size; }
+
+private:
+	const uint8_t* m_data = nullptr;
+	size_t         m_size = 0;
+};
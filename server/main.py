@@ -11,13 +11,14 @@ Model is downloaded automatically on first run:
     - YOLOv8n  (~6 MB, saved to working directory)
 """
 
+import struct
 from pathlib import Path
 from datetime import datetime
 
-from fastapi import FastAPI, File, UploadFile, HTTPException
+from fastapi import FastAPI, File, Form, UploadFile, HTTPException, Request, Response
 
 from database import init_db, insert_detection, get_all_detections
-from ocr import analyze_image, load_models
+from ocr import analyze_images, load_models
 
 # ── Debug switch ─────────────────────────────────────────────────────
 DEBUG: bool = True
@@ -25,6 +26,11 @@ DEBUG: bool = True
 # ── Configuration ─────────────────────────────────────────────────────
 RECEIVED_DIR = Path("received_images")
 
+# Compact response format; layout documented in DriveLens/CloudResponse.h
+BINARY_MEDIA_TYPE = "application/x-drivelens-detections"
+_BINARY_HEADER = struct.Struct("<4sHHqqH")
+_BINARY_RECORD = struct.Struct("<BHhhhh")
+
 app = FastAPI(title="DriveLens Cloud Server")
 
 
@@ -37,66 +43,110 @@ def startup():
     print(f"[Server] Saving images to: {RECEIVED_DIR.resolve()}")
 
 
+def _pack_detections(image_width: int, image_height: int,
+                      frame_index: int | None, capture_ns: int | None,
+                      objects: list) -> bytes:
+    """Encode a detection result in the compact binary format."""
+    parts = [_BINARY_HEADER.pack(b"DLD1", image_width, image_height,
+                                 -1 if frame_index is None else frame_index,
+                                 capture_ns or 0, len(objects))]
+    for obj in objects:
+        parts.append(_BINARY_RECORD.pack(
+            obj["class_id"], round(obj["confidence"] * 65535),
+            obj["x_min"], obj["y_min"], obj["x_max"], obj["y_max"]))
+    return b"".join(parts)
+
+
 @app.post("/upload")
-async def upload_frame(file: UploadFile = File(...)):
+async def upload_frame(request: Request,
+                       file: UploadFile | None = File(None),
+                       files: list[UploadFile] | None = File(None),
+                       frame_index: int | None = Form(None),
+                       capture_ns: int | None = Form(None)):
     """
     Receive a JPEG frame from the C++ edge client.
 
+    A request carries either one image as `file`, or several tiles of the
+    same frame as repeated `files` parts; tiles are detected as one YOLO
+    batch and answered per tile, in upload order.
+
+    `frame_index` and `capture_ns` (edge monotonic capture time) are optional
+    and echoed back unchanged, so the client can match the result to the
+    frame it was computed from.
+
     Pipeline:
-        1. Save image to disk
-        2. YOLOv8 object detection
+        1. Save image(s) to disk
+        2. YOLOv8 object detection (one batch)
         3. Store results in SQLite
-        4. Return JSON to C++ client
+        4. Return results to C++ client (binary if the Accept header asks
+           for it, JSON otherwise; tiles as consecutive binary records or a
+           "tiles" list)
     """
     try:
-        contents = await file.read()
+        tiled = bool(files)
+        uploads = files if tiled else ([file] if file else [])
+        if not uploads:
+            raise HTTPException(status_code=400, detail="No file received.")
 
-        if not contents:
+        contents = [await f.read() for f in uploads]
+        if not all(contents):
             raise HTTPException(status_code=400, detail="Empty file received.")
 
-        # --- 1. Save image to disk ---
+        # --- 1. Save images to disk ---
         timestamp = datetime.now().strftime("%Y%m%d_%H%M%S_%f")
-        filename = file.filename if file.filename else f"frame_{timestamp}.jpg"
-        save_path = RECEIVED_DIR / filename
-        save_path.write_bytes(contents)
+        filenames = []
+        for i, (upload, data) in enumerate(zip(uploads, contents)):
+            filename = upload.filename if upload.filename else f"frame_{timestamp}_{i}.jpg"
+            (RECEIVED_DIR / filename).write_bytes(data)
+            filenames.append(filename)
 
-        size_kb = len(contents) / 1024
+        size_kb = sum(len(c) for c in contents) / 1024
         print(f"\n{'='*60}")
-        print(f"Received image: {filename} ({size_kb:.1f} KB)")
+        print(f"Received {len(contents)} image(s): {', '.join(filenames)} ({size_kb:.1f} KB)")
 
         # --- 2. YOLOv8 object detection ---
-        vision_result = analyze_image(contents)
-
-        detected_objects = vision_result["objects"]
-        image_width      = vision_result["image_width"]
-        image_height     = vision_result["image_height"]
-
-        if DEBUG:
-            if detected_objects:
-                for obj in detected_objects:
-                    print(f"[OBJECT]  {obj['name']:<20s}  "
-                          f"confidence={obj['confidence']:.1%}  "
-                          f"bbox=({obj['x_min']},{obj['y_min']})-"
-                          f"({obj['x_max']},{obj['y_max']})")
-            else:
-                print(f"[OBJECT]  (no objects detected)")
+        vision_results = analyze_images(contents)
 
         # --- 3. Save to database ---
-        row_id = insert_detection(filename, detected_objects)
-        print(f"[DB] Saved detection #{row_id}")
+        tiles = []
+        for filename, data, vision_result in zip(filenames, contents, vision_results):
+            detected_objects = vision_result["objects"]
+
+            if DEBUG:
+                if detected_objects:
+                    for obj in detected_objects:
+                        print(f"[OBJECT]  {obj['name']:<20s}  "
+                              f"confidence={obj['confidence']:.1%}  "
+                              f"bbox=({obj['x_min']},{obj['y_min']})-"
+                              f"({obj['x_max']},{obj['y_max']})  [{filename}]")
+                else:
+                    print(f"[OBJECT]  (no objects detected)  [{filename}]")
+
+            row_id = insert_detection(filename, detected_objects)
+            print(f"[DB] Saved detection #{row_id}")
+            tiles.append({
+                "filename": filename,
+                "size_bytes": len(data),
+                "image_width": vision_result["image_width"],
+                "image_height": vision_result["image_height"],
+                "detected_objects": detected_objects,
+                "db_id": row_id,
+            })
         if DEBUG:
             print(f"{'='*60}")
 
-        # --- 4. Return JSON to C++ client ---
-        return {
-            "status": "ok",
-            "filename": filename,
-            "size_bytes": len(contents),
-            "image_width": image_width,
-            "image_height": image_height,
-            "detected_objects": detected_objects,
-            "db_id": row_id,
-        }
+        # --- 4. Return results to C++ client ---
+        if BINARY_MEDIA_TYPE in request.headers.get("accept", ""):
+            packed = b"".join(_pack_detections(t["image_width"], t["image_height"],
+                                               frame_index, capture_ns,
+                                               t["detected_objects"])
+                              for t in tiles)
+            return Response(content=packed, media_type=BINARY_MEDIA_TYPE)
+
+        echo = {"frame_index": frame_index, "capture_ns": capture_ns}
+        if tiled:
+            return {"status": "ok", "tiles": tiles, **echo}
+        return {"status": "ok", **tiles[0], **echo}
 
     except HTTPException:
         raise
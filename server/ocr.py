@@ -51,6 +51,31 @@ def _bytes_to_np(image_bytes: bytes) -> np.ndarray:
     return np.array(Image.open(io.BytesIO(image_bytes)).convert("RGB"))
 
 
+def _boxes_to_objects(result) -> list:
+    """Driving-relevant detections of one YOLO result, in image pixels."""
+    detected_objects = []
+    for box in result.boxes:
+        cls_id = int(box.cls[0])
+        if cls_id not in _RELEVANT_CLASS_IDS:
+            continue
+
+        conf = float(box.conf[0])
+        if conf < 0.40:
+            continue
+
+        x1, y1, x2, y2 = box.xyxy[0].tolist()
+        detected_objects.append({
+            "name":       _COCO_NAMES.get(cls_id, "unknown"),
+            "class_id":   cls_id,
+            "confidence": round(conf, 3),
+            "x_min":      round(x1),
+            "y_min":      round(y1),
+            "x_max":      round(x2),
+            "y_max":      round(y2),
+        })
+    return detected_objects
+
+
 def analyze_image(image_bytes: bytes) -> dict:
     """
     Run YOLOv8 on the given image bytes.
@@ -60,45 +85,39 @@ def analyze_image(image_bytes: bytes) -> dict:
             "image_width": 640,
             "image_height": 480,
             "objects": [
-                {"name": "car", "confidence": 0.91,
+                {"name": "car", "class_id": 2, "confidence": 0.91,
                  "x_min": 120, "y_min": 45, "x_max": 310, "y_max": 220},
                 ...
             ]
         }
     Coordinates are in pixels relative to the analyzed image.
     """
+    return analyze_images([image_bytes])[0]
+
+
+def analyze_images(images: list[bytes]) -> list[dict]:
+    """
+    Run YOLOv8 on several images (e.g. tiles of one frame) as one batch.
+
+    Returns one analyze_image()-shaped dict per input, in input order.
+    """
     yolo = _get_model()
-    image_np = _bytes_to_np(image_bytes)
-    h, w = image_np.shape[:2]
+    arrays = [_bytes_to_np(b) for b in images]
+    per_image = [[] for _ in arrays]
 
     # ── YOLO Object Detection ─────────────────────────────────────────
-    detected_objects = []
     try:
-        results = yolo(image_np, device="cpu", verbose=False)
-        if results:
-            for box in results[0].boxes:
-                cls_id = int(box.cls[0])
-                if cls_id not in _RELEVANT_CLASS_IDS:
-                    continue
-
-                conf = float(box.conf[0])
-                if conf < 0.40:
-                    continue
-
-                x1, y1, x2, y2 = box.xyxy[0].tolist()
-                detected_objects.append({
-                    "name":       _COCO_NAMES.get(cls_id, "unknown"),
-                    "confidence": round(conf, 3),
-                    "x_min":      round(x1),
-                    "y_min":      round(y1),
-                    "x_max":      round(x2),
-                    "y_max":      round(y2),
-                })
+        results = yolo(arrays, device="cpu", verbose=False)
+        for i, result in enumerate(results):
+            per_image[i] = _boxes_to_objects(result)
     except Exception as e:
         print(f"[YOLO] Warning: {e}")
 
-    return {
-        "image_width":  w,
-        "image_height": h,
-        "objects":      detected_objects,
-    }
+    return [
+        {
+            "image_width":  a.shape[1],
+            "image_height": a.shape[0],
+            "objects":      objects,
+        }
+        for a, objects in zip(arrays, per_image)
+    ]